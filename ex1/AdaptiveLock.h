@@ -0,0 +1,249 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include "McsLock.h"
+#include "SpinWait.h"
+
+// Блокировка, которая на ходу выбирает алгоритм по наблюдаемой конкуренции:
+//   TAS   - мало конкуренции и короткие секции: один RMW на захват;
+//   MCS   - много ожидающих и короткие секции: каждый крутится на своей линии;
+//   Mutex - длинные секции или долгие ожидания (потоков больше, чем ядер):
+//           ожидающие засыпают, а не жгут процессор.
+//
+// Держатель раз в окно из window захватов смотрит на долю захватов с ожиданием,
+// среднее ожидание и среднее удержание и, если нужно, переключает режим.
+// Переключение делается только держателем в unlock(), уже после критической
+// секции. Поток, который ждал на старом алгоритме, после захвата перечитывает
+// режим и, если тот сменился, отпускает старую блокировку и встаёт в новую -
+// поэтому в секции никогда не бывает двух потоков.
+//
+// Гистерезис: пороги входа в режим строже порогов выхода, и смена происходит,
+// только если два окна подряд выбрали один и тот же новый режим.
+class AdaptiveLock {
+public:
+    enum class Mode : int { Tas = 0, Mcs = 1, Mutex = 2 };
+
+    static const char* modeName(Mode mode) {
+        switch (mode) {
+            case Mode::Tas: return "TAS";
+            case Mode::Mcs: return "MCS";
+            case Mode::Mutex: return "Mutex";
+        }
+        return "?";
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int holdSamplePeriod = 16; // удержание замеряется у каждого 16-го захвата
+
+    // Пороги: {вход в режим, выход из режима}
+    static constexpr long long mutexHoldNs[2] = {10000, 2000};
+    static constexpr long long mutexWaitNs[2] = {100000, 20000};
+    static constexpr double mcsContended[2] = {0.5, 0.1};
+
+    alignas(64) std::atomic<bool> tasFlag{false};
+    alignas(64) McsLock mcs;
+    alignas(64) std::mutex mtx;
+    alignas(64) std::atomic<Mode> mode;
+
+    // Ниже - только под блокировкой (пишет держатель)
+    Mode held = Mode::Tas;
+    const int window;
+    int windowAcquisitions = 0;
+    int windowContended = 0;
+    long long windowWaitNs = 0;
+    int holdSamples = 0;
+    long long windowHoldNs = 0;
+    bool sampleHold = false;
+    Clock::time_point holdStart;
+    Mode candidate = Mode::Tas;
+    int streak = 0;
+    long long perMode[3] = {0, 0, 0};
+    long long switches = 0;
+
+    static long long nsSince(Clock::time_point t0) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+    }
+
+    // Test-and-test-and-set: пока занято, только читаем
+    void tasLock() {
+        SpinWait spin(SpinPolicy::handoff());
+        do {
+            while (tasFlag.load(std::memory_order_relaxed)) {
+                spin.spinOnce();
+            }
+        } while (tasFlag.exchange(true, std::memory_order_acquire));
+    }
+
+    // Захват в режиме m; возвращает время ожидания (0 - захват без ожидания)
+    long long acquire(Mode m) {
+        switch (m) {
+            case Mode::Tas:
+                if (!tasFlag.exchange(true, std::memory_order_acquire)) {
+                    return 0;
+                } else {
+                    auto t0 = Clock::now();
+                    tasLock();
+                    return std::max(1LL, nsSince(t0));
+                }
+            case Mode::Mcs:
+                if (mcs.try_lock()) {
+                    return 0;
+                } else {
+                    auto t0 = Clock::now();
+                    mcs.lock();
+                    return std::max(1LL, nsSince(t0));
+                }
+            case Mode::Mutex:
+                if (mtx.try_lock()) {
+                    return 0;
+                } else {
+                    auto t0 = Clock::now();
+                    mtx.lock();
+                    return std::max(1LL, nsSince(t0));
+                }
+        }
+        return 0;
+    }
+
+    void release(Mode m) {
+        switch (m) {
+            case Mode::Tas: tasFlag.store(false, std::memory_order_release); break;
+            case Mode::Mcs: mcs.unlock(); break;
+            case Mode::Mutex: mtx.unlock(); break;
+        }
+    }
+
+    // Итог окна; вызывается держателем до освобождения. Возвращает режим, который
+    // unlock() опубликует последним шагом: после публикации блокировку нового режима
+    // уже может взять ожидающий, а поля окна к этому моменту должны быть сброшены
+    Mode decide() {
+        int current = static_cast<int>(held);
+        double contendedShare = static_cast<double>(windowContended) / windowAcquisitions;
+        long long avgWait = windowContended ? windowWaitNs / windowContended : 0;
+        long long avgHold = holdSamples ? windowHoldNs / holdSamples : 0;
+
+        auto threshold = [current](const auto& pair, Mode m) {
+            return pair[current == static_cast<int>(m) ? 1 : 0];
+        };
+
+        Mode target;
+        if (avgHold > threshold(mutexHoldNs, Mode::Mutex) || avgWait > threshold(mutexWaitNs, Mode::Mutex)) {
+            target = Mode::Mutex;
+        } else if (contendedShare > threshold(mcsContended, Mode::Mcs)) {
+            target = Mode::Mcs;
+        } else {
+            target = Mode::Tas;
+        }
+
+        Mode next = held;
+        if (target == held) {
+            streak = 0;
+        } else if (target == candidate && ++streak >= 2) {
+            streak = 0;
+            ++switches;
+            next = target;
+        } else if (target != candidate) {
+            candidate = target;
+            streak = 1;
+        }
+
+        windowAcquisitions = 0;
+        windowContended = 0;
+        windowWaitNs = 0;
+        holdSamples = 0;
+        windowHoldNs = 0;
+        return next;
+    }
+
+public:
+    explicit AdaptiveLock(Mode initial = Mode::Tas, int windowSize = 256)
+        : mcs(SpinPolicy::handoff()), mode(initial), window(windowSize) {}
+
+    AdaptiveLock(const AdaptiveLock&) = delete;
+    AdaptiveLock& operator=(const AdaptiveLock&) = delete;
+
+    void lock() {
+        for (;;) {
+            Mode m = mode.load(std::memory_order_acquire);
+            long long waited = acquire(m);
+            if (mode.load(std::memory_order_acquire) != m) {
+                // Режим сменили, пока мы ждали: эта блокировка больше ничего не охраняет
+                release(m);
+                continue;
+            }
+            held = m;
+            ++perMode[static_cast<int>(m)];
+            ++windowAcquisitions;
+            if (waited > 0) {
+                ++windowContended;
+                windowWaitNs += waited;
+            }
+            sampleHold = (windowAcquisitions % holdSamplePeriod == 0);
+            if (sampleHold) {
+                holdStart = Clock::now();
+            }
+            return;
+        }
+    }
+
+    bool try_lock() {
+        Mode m = mode.load(std::memory_order_acquire);
+        bool acquired = false;
+        switch (m) {
+            case Mode::Tas: acquired = !tasFlag.exchange(true, std::memory_order_acquire); break;
+            case Mode::Mcs: acquired = mcs.try_lock(); break;
+            case Mode::Mutex: acquired = mtx.try_lock(); break;
+        }
+        if (!acquired) {
+            return false;
+        }
+        if (mode.load(std::memory_order_acquire) != m) {
+            release(m);
+            return false;
+        }
+        held = m;
+        ++perMode[static_cast<int>(m)];
+        ++windowAcquisitions;
+        sampleHold = false;
+        return true;
+    }
+
+    void unlock() {
+        Mode m = held;
+        if (sampleHold) {
+            windowHoldNs += nsSince(holdStart);
+            ++holdSamples;
+            sampleHold = false;
+        }
+        if (windowAcquisitions >= window) {
+            Mode next = decide();
+            if (next != m) {
+                mode.store(next, std::memory_order_release);
+            }
+        }
+        release(m);
+    }
+
+    Mode currentMode() const {
+        return mode.load(std::memory_order_relaxed);
+    }
+
+    long long switchCount() const {
+        return switches;
+    }
+
+    // Вызывать, когда блокировку никто не держит
+    void printStats(std::ostream& out = std::cout) const {
+        out << "    AdaptiveLock: mode " << modeName(currentMode())
+            << ", switches " << switches
+            << ", acquisitions TAS " << perMode[0]
+            << " / MCS " << perMode[1]
+            << " / Mutex " << perMode[2] << "\n";
+    }
+};
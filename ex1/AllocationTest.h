@@ -0,0 +1,261 @@
+#pragma once
+
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "NodeAllocators.h"
+#include "Locks.h"
+#include "CpuUsage.h"
+#include "Tracer.h"
+
+// Опорная точка без распределителя: у потока запас заранее выделенных блоков,
+// освобождённые блоки возвращаются в запас освободившего потока. Запас исчерпается,
+// только если поток сделает на stash больше push, чем pop - тогда обычный new.
+class PreallocatedNodeAllocator {
+private:
+    size_t blockBytes;
+    size_t stash;
+public:
+    explicit PreallocatedNodeAllocator(size_t bytes, size_t stashBlocks = 4096)
+        : blockBytes(bytes), stash(stashBlocks) {}
+
+    class Local {
+    private:
+        PreallocatedNodeAllocator& owner;
+        std::vector<void*> blocks;
+    public:
+        explicit Local(PreallocatedNodeAllocator& allocator) : owner(allocator) {
+            blocks.reserve(4 * owner.stash);
+            for (size_t k = 0; k < owner.stash; ++k) {
+                blocks.push_back(::operator new(owner.blockBytes));
+            }
+        }
+        Local(const Local&) = delete;
+        Local& operator=(const Local&) = delete;
+
+        ~Local() {
+            for (void* p : blocks) {
+                ::operator delete(p, owner.blockBytes);
+            }
+        }
+
+        void* allocate() {
+            if (blocks.empty()) {
+                return ::operator new(owner.blockBytes);
+            }
+            void* p = blocks.back();
+            blocks.pop_back();
+            return p;
+        }
+
+        void deallocate(void* p) { blocks.push_back(p); }
+    };
+};
+
+// Гонка "контейнер с выделением под блокировкой": общий интрузивный стек узлов
+// под одной блокировкой, каждая критическая секция либо выделяет узел и кладёт
+// его, либо снимает узел и освобождает. Узлы часто освобождает не тот поток,
+// который их выделил. Сравнение с PreallocatedNodeAllocator показывает, какая
+// часть "цены блокировки" на самом деле - цена распределителя: он работает
+// внутри секции и удлиняет удержание.
+class AllocationRaceTest {
+private:
+    static constexpr size_t kPayloadBytes = 40;
+    // Метка узла, лежащего в стеке. Пишется и стирается только под блокировкой,
+    // стирается до возврата блока распределителю
+    static constexpr std::uint64_t kLiveTag = 0x4c4956454e4f4445ULL;
+
+    struct Node {
+        Node* next;
+        std::uint64_t live;
+        char payload[kPayloadBytes];
+    };
+
+    // Метка читается из сырого блока, до создания в нём Node
+    static bool isLive(const void* block) {
+        std::uint64_t tag;
+        std::memcpy(&tag, static_cast<const char*>(block) + offsetof(Node, live), sizeof(tag));
+        return tag == kLiveTag;
+    }
+
+    int numThreads;
+    int opsPerThread;
+    int prefill;
+    int repeats;
+
+    struct RunResult {
+        RunEfficiency efficiency;
+        long emptyPops = 0;
+        long corrupted = 0;
+    };
+
+    // Один прогон без вывода
+    template <typename Lock, typename Allocator>
+    RunResult runOnce([[maybe_unused]] const std::string& name, Allocator& allocator) {
+        Lock lock;
+        Node* top = nullptr;
+        {
+            typename Allocator::Local local(allocator);
+            for (int i = 0; i < prefill; ++i) {
+                Node* node = new (local.allocate()) Node{top, kLiveTag, {}};
+                top = node;
+            }
+        }
+
+        std::vector<std::thread> threads;
+        std::vector<CpuUsage> cpu(numThreads);
+        std::vector<long> empties(numThreads, 0);
+        // Выданный блок уже помечен как лежащий в стеке - распределитель выдал
+        // живой блок второй раз. Такой блок в стек не кладётся: иначе получится цикл
+        std::vector<long> corrupted(numThreads, 0);
+        // Заведение и сброс Local (запас опорной точки, кэши пула) - вне замера
+        std::barrier<> phase(numThreads + 1);
+
+        for (int t = 0; t < numThreads; ++t) {
+            threads.emplace_back([&, t]() {
+                typename Allocator::Local local(allocator);
+                std::mt19937 coin(t + 1);
+                phase.arrive_and_wait();
+                CpuUsage cpuStart = CpuUsage::thisThread();
+                RACE_TRACE_PHASE_BEGIN("alloc " + name);
+                for (int j = 0; j < opsPerThread; ++j) {
+                    if (coin() & 1) {
+                        std::lock_guard<Lock> guard(lock);
+                        void* block = local.allocate();
+                        if (block == top || isLive(block)) {
+                            ++corrupted[t];
+                            continue;
+                        }
+                        Node* node = new (block) Node{top, kLiveTag, {}};
+                        std::memset(node->payload, j, kPayloadBytes);
+                        top = node;
+                    } else {
+                        std::lock_guard<Lock> guard(lock);
+                        if (Node* node = top) {
+                            top = node->next;
+                            node->live = 0;
+                            node->~Node();
+                            local.deallocate(node);
+                        } else {
+                            ++empties[t];
+                        }
+                    }
+                }
+                RACE_TRACE_PHASE_END("alloc " + name);
+                cpu[t] = CpuUsage::thisThread() - cpuStart;
+                phase.arrive_and_wait();
+            });
+        }
+        phase.arrive_and_wait();
+        auto start = std::chrono::high_resolution_clock::now();
+        phase.arrive_and_wait();
+        auto end = std::chrono::high_resolution_clock::now();
+        for (auto& th : threads) {
+            th.join();
+        }
+        double seconds = std::chrono::duration<double>(end - start).count();
+
+        {
+            typename Allocator::Local local(allocator);
+            while (Node* node = top) {
+                top = node->next;
+                node->live = 0;
+                node->~Node();
+                local.deallocate(node);
+            }
+        }
+
+        RunResult result;
+        for (int t = 0; t < numThreads; ++t) {
+            result.emptyPops += empties[t];
+            result.corrupted += corrupted[t];
+        }
+        result.efficiency = RunEfficiency::fromThreads(seconds, 1LL * numThreads * opsPerThread, cpu);
+        return result;
+    }
+
+    // repeats прогонов на одном распределителе, печатается медианный по пропускной способности
+    template <typename Lock, typename Allocator>
+    RunEfficiency run(const std::string& name, Allocator& allocator) {
+        std::vector<RunResult> runs;
+        long corrupted = 0;
+        for (int r = 0; r < repeats; ++r) {
+            runs.push_back(runOnce<Lock>(name, allocator));
+            corrupted += runs.back().corrupted;
+        }
+        std::sort(runs.begin(), runs.end(), [](const RunResult& a, const RunResult& b) {
+            return a.efficiency.throughput() < b.efficiency.throughput();
+        });
+        const RunResult& median = runs[runs.size() / 2];
+        std::cout << name << " - " << static_cast<long long>(median.efficiency.throughput()) << " ops/sec, "
+                  << std::fixed << std::setprecision(1) << 1e9 / std::max(median.efficiency.throughput(), 1.0)
+                  << " ns/op" << std::defaultfloat << " (median of " << repeats << ")"
+                  << (median.emptyPops ? ", empty pops " + std::to_string(median.emptyPops) : "")
+                  << (corrupted ? ", CORRUPTED NODES " + std::to_string(corrupted) : "") << "\n";
+        median.efficiency.print();
+        return median.efficiency;
+    }
+
+    // Прирост времени операции относительно опорной точки - цена распределителя под блокировкой
+    static void printOverhead(const RunEfficiency& run, const RunEfficiency& baseline) {
+        double ns = 1e9 / std::max(run.throughput(), 1.0);
+        double baseNs = 1e9 / std::max(baseline.throughput(), 1.0);
+        // Отрицательное значение - шум прогона (например, вытеснение держателя spin-блокировки)
+        std::cout << "    allocator share: " << std::showpos << std::fixed << std::setprecision(1) << ns - baseNs
+                  << " ns/op over preallocated (" << 100.0 * (ns - baseNs) / ns
+                  << "% of op time)\n" << std::noshowpos << std::defaultfloat;
+    }
+
+    template <typename Lock>
+    void runAllAllocators(const std::string& lockName) {
+        std::cout << "--- " << lockName << " ---\n";
+        RunEfficiency baseline;
+        {
+            PreallocatedNodeAllocator allocator(sizeof(Node));
+            baseline = run<Lock>(lockName + " + preallocated       ", allocator);
+        }
+        {
+            MallocNodeAllocator allocator(sizeof(Node));
+            printOverhead(run<Lock>(lockName + " + glibc malloc       ", allocator), baseline);
+        }
+        {
+            PmrPoolNodeAllocator allocator(sizeof(Node));
+            printOverhead(run<Lock>(lockName + " + pmr synchronized   ", allocator), baseline);
+        }
+        {
+            ThreadCachePoolAllocator allocator(sizeof(Node));
+            printOverhead(run<Lock>(lockName + " + thread-cache pool  ", allocator), baseline);
+            std::cout << "    slabs " << allocator.slabCount() << "\n";
+        }
+        {
+            LockFreeFreelistAllocator allocator(sizeof(Node));
+            printOverhead(run<Lock>(lockName + " + lock-free freelist ", allocator), baseline);
+            std::cout << "    slabs " << allocator.slabCount() << "\n";
+        }
+        std::cout << "\n";
+    }
+
+public:
+    AllocationRaceTest(int threads, int ops = 200000, int prefillNodes = 1024, int runsPerPoint = 5)
+        : numThreads(threads), opsPerThread(ops), prefill(prefillNodes), repeats(std::max(1, runsPerPoint)) {}
+
+    void runAllTests() {
+        std::cout << "=== Allocation under contention ===\n";
+        std::cout << "Threads: " << numThreads << ", Push/pop ops per thread: " << opsPerThread
+                  << ", Prefill: " << prefill << ", Runs per point: " << repeats << ", Node: " << sizeof(Node) << " bytes\n\n";
+
+        runAllAllocators<std::mutex>("std::mutex");
+        runAllAllocators<TasSpinLock>("spinlock  ");
+    }
+};
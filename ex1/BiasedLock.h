@@ -0,0 +1,169 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include "SpinWait.h"
+
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Смещённая (biased) блокировка для мест, которые почти всегда берёт один поток.
+//
+// Первый захвативший поток становится владельцем смещения. Его быстрый путь -
+// асимметричный алгоритм Деккера без RMW-операций: обычная запись своего флага,
+// барьер компилятора и чтение флага чужого потока. Тяжёлую половину барьера
+// платят остальные потоки: membarrier(PRIVATE_EXPEDITED) заставляет все ядра
+// процесса выполнить полный барьер. Если membarrier недоступен, владелец ставит
+// полный барьер сам (mfence - всё ещё без RMW).
+//
+// Чужие потоки сериализуются на внутреннем мьютексе. Если за время смещения
+// чужих захватов набралось revokeThreshold, смещение отзывается и дальше
+// все, включая владельца, идут через мьютекс.
+class BiasedLock {
+private:
+    std::atomic<const void*> biasOwner{nullptr};
+    std::atomic<bool> ownerWants{false};
+    std::atomic<bool> otherWants{false};
+    std::atomic<bool> biased{true};
+    std::mutex fallback;
+    // true только пока владелец в секции по быстрому пути. Пишет только владелец,
+    // но после отзыва unlock() чужого потока тоже читает флаг - поэтому atomic.
+    std::atomic<bool> ownerFastPath{false};
+    int foreignAcquisitions = 0; // под fallback
+    const int revokeThreshold;
+
+    // Статистика
+    std::atomic<long long> ownerFast{0};
+    std::atomic<long long> ownerSlow{0};
+    std::atomic<long long> foreign{0};
+    std::atomic<long long> revocations{0};
+    std::atomic<long long> handshakes{0};
+    std::atomic<long long> handshakeNs{0};
+
+    static const void* threadToken() {
+        static thread_local char token;
+        return &token;
+    }
+
+    static bool registerMembarrier() {
+        return syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0, 0) == 0;
+    }
+
+    static bool membarrierAvailable() {
+        static const bool available = registerMembarrier();
+        return available;
+    }
+
+    // Лёгкая половина: достаточно запретить компилятору переставлять доступы
+    static void lightBarrier() {
+        if (membarrierAvailable()) {
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+        } else {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    // Тяжёлая половина: полный барьер на всех ядрах, где идут потоки процесса
+    static void heavyBarrier() {
+        if (membarrierAvailable()) {
+            syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0);
+        } else {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    bool isOwner() {
+        const void* me = threadToken();
+        const void* owner = biasOwner.load(std::memory_order_relaxed);
+        if (owner == nullptr) {
+            // Единственная RMW за жизнь смещения - выбор владельца
+            biasOwner.compare_exchange_strong(owner, me, std::memory_order_relaxed);
+            owner = biasOwner.load(std::memory_order_relaxed);
+        }
+        return owner == me;
+    }
+
+public:
+    explicit BiasedLock(int revokeAfter = 64) : revokeThreshold(revokeAfter) {
+        membarrierAvailable();
+    }
+
+    void lock() {
+        if (isOwner()) {
+            if (biased.load(std::memory_order_relaxed)) {
+                ownerWants.store(true, std::memory_order_relaxed);
+                lightBarrier();
+                // Смещение могли отозвать между первой проверкой и рукопожатием:
+                // отозвавший уже отпустил блокировку и сбросил otherWants, а следующий
+                // чужой поток увидит biased == false и пойдёт без рукопожатия.
+                // Перепроверка после ownerWants = true закрывает окно: либо мы видим
+                // отзыв, либо отзывающий (он пишет biased под fallback после heavyBarrier)
+                // ещё ждёт, пока ownerWants не сбросится.
+                if (!otherWants.load(std::memory_order_acquire) && biased.load(std::memory_order_acquire)) {
+                    ownerFastPath.store(true, std::memory_order_relaxed);
+                    // Счётчик пишет только владелец - обходимся без RMW
+                    ownerFast.store(ownerFast.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                    return;
+                }
+                ownerWants.store(false, std::memory_order_release);
+            }
+            fallback.lock();
+            ownerSlow.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        // Чужой поток: сначала отсекаем других чужих, затем рукопожатие с владельцем
+        fallback.lock();
+        foreign.fetch_add(1, std::memory_order_relaxed);
+        if (!biased.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        otherWants.store(true, std::memory_order_relaxed);
+        heavyBarrier();
+        SpinWait spin(SpinPolicy::escalating().withoutPark());
+        while (ownerWants.load(std::memory_order_acquire)) {
+            spin.spinOnce();
+        }
+        if (++foreignAcquisitions >= revokeThreshold) {
+            // Отзыв: владелец сейчас не в секции и увидит biased == false
+            biased.store(false, std::memory_order_relaxed);
+            revocations.fetch_add(1, std::memory_order_relaxed);
+        }
+        handshakes.fetch_add(1, std::memory_order_relaxed);
+        handshakeNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - t0).count(), std::memory_order_relaxed);
+    }
+
+    void unlock() {
+        if (ownerFastPath.load(std::memory_order_relaxed)) {
+            ownerFastPath.store(false, std::memory_order_relaxed);
+            ownerWants.store(false, std::memory_order_release);
+            return;
+        }
+        otherWants.store(false, std::memory_order_release);
+        fallback.unlock();
+    }
+
+    // Снова сместить на первого следующего захватившего (вызывать без держателей)
+    void rebias() {
+        biasOwner.store(nullptr, std::memory_order_relaxed);
+        foreignAcquisitions = 0;
+        biased.store(true, std::memory_order_release);
+    }
+
+    void printStats(std::ostream& out = std::cout) const {
+        long long n = handshakes.load();
+        out << "    BiasedLock: owner fast " << ownerFast.load()
+            << ", owner slow " << ownerSlow.load()
+            << ", foreign " << foreign.load()
+            << ", revocations " << revocations.load()
+            << ", avg foreign handshake " << (n ? handshakeNs.load() / n : 0) << " ns"
+            << (membarrierAvailable() ? " (membarrier)" : " (mfence)") << "\n";
+    }
+};
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Движок BSP (bulk-synchronous parallel) поверх std::barrier.
+// Команда из workers потоков выполняет одно и то же ядро фаза за фазой; между
+// фазами - барьер, а на барьере последний пришедший поток выполняет шаг
+// завершения (редукции, проверка сходимости, смена буферов). Шаг завершения
+// может остановить вычисление, вернув false.
+//
+// Раздельный барьер: ядро может вызвать worker.arrive(), сделать работу, которая
+// не зависит от результатов других потоков этой фазы, и только потом
+// worker.wait() - так эта работа перекрывается с ожиданием отставших.
+// Если ядро не вызвало arrive()/wait(), движок сделает это сам после ядра.
+class BspEngine {
+private:
+    struct PhaseDone {
+        BspEngine* engine;
+        void operator()() noexcept { engine->onPhaseComplete(); }
+    };
+    using Barrier = std::barrier<PhaseDone>;
+
+public:
+    class Worker {
+    private:
+        friend class BspEngine;
+
+        BspEngine& engine;
+        std::optional<Barrier::arrival_token> token;
+        bool arrived = false;
+        bool waited = false;
+        long long idleNs = 0;
+
+        Worker(BspEngine& owner, int workerId) : engine(owner), id(workerId) {}
+
+    public:
+        const int id;
+        int phase = 0;
+
+        int workers() const {
+            return engine.numWorkers;
+        }
+
+        // Полуинтервал [begin, end) этого потока при равномерном разбиении n элементов
+        std::pair<size_t, size_t> partition(size_t n) const {
+            size_t chunk = n / engine.numWorkers;
+            size_t extra = n % engine.numWorkers;
+            size_t begin = id * chunk + std::min<size_t>(id, extra);
+            return {begin, begin + chunk + (static_cast<size_t>(id) < extra ? 1 : 0)};
+        }
+
+        // Поток закончил работу фазы, которая нужна другим
+        void arrive() {
+            if (!arrived) {
+                token = engine.barrier.arrive();
+                arrived = true;
+            }
+        }
+
+        // Дождаться, пока фазу закончат все (и выполнится шаг завершения)
+        void wait() {
+            if (waited) {
+                return;
+            }
+            auto t0 = std::chrono::steady_clock::now();
+            if (arrived) {
+                engine.barrier.wait(std::move(*token));
+                token.reset();
+            } else {
+                engine.barrier.arrive_and_wait();
+                arrived = true;
+            }
+            idleNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - t0).count();
+            waited = true;
+        }
+    };
+
+    // Итог прогона
+    struct Stats {
+        int phases = 0;
+        double wallSec = 0;
+        std::vector<long long> phaseNs;       // длительность каждой фазы
+        std::vector<long long> workerIdleNs;  // суммарное ожидание на барьере по потокам
+
+        double avgPhaseUs() const {
+            if (phaseNs.empty()) {
+                return 0;
+            }
+            long long sum = 0;
+            for (long long ns : phaseNs) {
+                sum += ns;
+            }
+            return sum / 1e3 / phaseNs.size();
+        }
+    };
+
+    using Kernel = std::function<void(Worker&)>;
+    using Completion = std::function<bool(int phase)>;
+
+private:
+    int numWorkers;
+    Barrier barrier;
+    Completion completion;
+    int currentPhase = 0;
+    bool stopRequested = false;
+    std::chrono::steady_clock::time_point phaseStart;
+    std::vector<long long> phaseNs;
+
+    // Выполняется ровно одним потоком, пока остальные стоят на барьере
+    void onPhaseComplete() noexcept {
+        auto now = std::chrono::steady_clock::now();
+        phaseNs.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(now - phaseStart).count());
+        if (completion && !completion(currentPhase)) {
+            stopRequested = true;
+        }
+        ++currentPhase;
+        phaseStart = std::chrono::steady_clock::now();
+    }
+
+public:
+    explicit BspEngine(int workers)
+        : numWorkers(workers), barrier(workers, PhaseDone{this}) {}
+
+    BspEngine(const BspEngine&) = delete;
+    BspEngine& operator=(const BspEngine&) = delete;
+
+    // Выполнить до maxPhases фаз; completion(phase) -> false останавливает после этой фазы
+    Stats run(int maxPhases, const Kernel& kernel, Completion onComplete = {}) {
+        completion = std::move(onComplete);
+        currentPhase = 0;
+        stopRequested = false;
+        phaseNs.clear();
+        phaseNs.reserve(maxPhases);
+
+        std::vector<long long> idle(numWorkers, 0);
+        std::vector<std::thread> team;
+        auto start = std::chrono::steady_clock::now();
+        phaseStart = start;
+
+        for (int w = 0; w < numWorkers; ++w) {
+            team.emplace_back([this, w, maxPhases, &kernel, &idle]() {
+                Worker worker(*this, w);
+                for (int phase = 0; phase < maxPhases; ++phase) {
+                    worker.phase = phase;
+                    worker.arrived = false;
+                    worker.waited = false;
+                    kernel(worker);
+                    worker.wait();
+                    // Шаг завершения выполнен до выхода из барьера, флаг виден всем
+                    if (stopRequested) {
+                        break;
+                    }
+                }
+                idle[w] = worker.idleNs;
+            });
+        }
+        for (auto& t : team) {
+            t.join();
+        }
+
+        Stats stats;
+        stats.phases = currentPhase;
+        stats.wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        stats.phaseNs = phaseNs;
+        stats.workerIdleNs = std::move(idle);
+        return stats;
+    }
+};
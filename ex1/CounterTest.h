@@ -0,0 +1,331 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sched.h>
+#include <unistd.h>
+
+#include "CpuUsage.h"
+#include "Tracer.h"
+
+// Счётчики с одинаковым интерфейсом: increment(thread) и read().
+// thread - номер потока в прогоне (0..maxThreads-1), нужен шардам и дереву.
+
+// Один atomic, fetch_add на каждое увеличение
+class AtomicCounter {
+private:
+    std::atomic<long> value{0};
+public:
+    explicit AtomicCounter(int) {}
+    void increment(int) { value.fetch_add(1, std::memory_order_relaxed); }
+    long read() const { return value.load(std::memory_order_relaxed); }
+};
+
+class MutexCounter {
+private:
+    long value = 0;
+    mutable std::mutex mtx;
+public:
+    explicit MutexCounter(int) {}
+    void increment(int) {
+        std::lock_guard<std::mutex> lock(mtx);
+        ++value;
+    }
+    long read() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return value;
+    }
+};
+
+// Ячейка на поток, каждая на своей кэш-линии; чтение суммирует все ячейки
+class ShardedCounter {
+private:
+    struct alignas(64) Shard {
+        std::atomic<long> value{0};
+    };
+    std::unique_ptr<Shard[]> shards;
+    int count;
+public:
+    explicit ShardedCounter(int maxThreads) : shards(new Shard[maxThreads]), count(maxThreads) {}
+
+    // Ячейку пишет только её поток, поэтому RMW не нужна
+    void increment(int thread) {
+        auto& v = shards[thread].value;
+        v.store(v.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    long read() const {
+        long sum = 0;
+        for (int i = 0; i < count; ++i) {
+            sum += shards[i].value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+};
+
+// Ячейка на процессор по sched_getcpu(). Поток может переехать на другой
+// процессор между sched_getcpu() и записью, поэтому нужна атомарная RMW
+// (её убирает только rseq, которого нет в стандартной библиотеке), но почти
+// всегда линия уже в кэше своего ядра.
+class PerCpuCounter {
+private:
+    struct alignas(64) Shard {
+        std::atomic<long> value{0};
+    };
+    std::unique_ptr<Shard[]> shards;
+    int count;
+public:
+    explicit PerCpuCounter(int)
+        : count(static_cast<int>(std::max(1L, sysconf(_SC_NPROCESSORS_CONF)))) {
+        shards.reset(new Shard[count]);
+    }
+
+    void increment(int) {
+        int cpu = sched_getcpu();
+        shards[cpu >= 0 ? cpu % count : 0].value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    long read() const {
+        long sum = 0;
+        for (int i = 0; i < count; ++i) {
+            sum += shards[i].value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+};
+
+// Программное дерево объединения (Herlihy, Shavit, "The Art of Multiprocessor
+// Programming", 12.3). Два потока, встретившиеся в узле, объединяют свои
+// увеличения: дальше к корню идёт только первый, второй ждёт и получает
+// результат при раздаче. Корень трогает не каждый поток, а цепочка пар.
+class CombiningTreeCounter {
+private:
+    enum class Status { Idle, First, Second, Result, Root };
+
+    struct alignas(64) Node {
+        std::mutex mtx;
+        std::condition_variable cv;
+        Status status = Status::Idle;
+        bool locked = false;
+        long firstValue = 0;
+        long secondValue = 0;
+        long result = 0;
+        Node* parent = nullptr;
+
+        // true - этот поток первым пришёл в узел и идёт выше
+        bool precombine() {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [this]() { return !locked; });
+            switch (status) {
+                case Status::Idle:
+                    status = Status::First;
+                    return true;
+                case Status::First:
+                    locked = true;
+                    status = Status::Second;
+                    return false;
+                default:
+                    return false; // Root
+            }
+        }
+
+        long combine(long combined) {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [this]() { return !locked; });
+            locked = true;
+            firstValue = combined;
+            return status == Status::Second ? firstValue + secondValue : firstValue;
+        }
+
+        long op(long combined) {
+            std::unique_lock<std::mutex> lock(mtx);
+            if (status == Status::Root) {
+                long prior = result;
+                result += combined;
+                return prior;
+            }
+            // Second: отдаём своё значение первому и ждём раздачи
+            secondValue = combined;
+            locked = false;
+            cv.notify_all();
+            cv.wait(lock, [this]() { return status == Status::Result; });
+            locked = false;
+            cv.notify_all();
+            status = Status::Idle;
+            return result;
+        }
+
+        void distribute(long prior) {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (status == Status::First) {
+                status = Status::Idle;
+                locked = false;
+            } else {
+                result = prior + firstValue;
+                status = Status::Result;
+            }
+            cv.notify_all();
+        }
+    };
+
+    std::unique_ptr<Node[]> nodes;
+    int leaves;
+    int leafBase;
+
+public:
+    explicit CombiningTreeCounter(int maxThreads) {
+        int width = 2;
+        while (width < maxThreads) {
+            width *= 2;
+        }
+        nodes.reset(new Node[width - 1]);
+        nodes[0].status = Status::Root;
+        for (int i = 1; i < width - 1; ++i) {
+            nodes[i].parent = &nodes[(i - 1) / 2];
+        }
+        leaves = width / 2;
+        leafBase = width - 1 - leaves;
+    }
+
+    // Возвращает значение до увеличения
+    long getAndIncrement(int thread) {
+        Node* leaf = &nodes[leafBase + (thread / 2) % leaves];
+        Node* node = leaf;
+        while (node->precombine()) {
+            node = node->parent;
+        }
+        Node* stop = node;
+
+        std::vector<Node*> path;
+        long combined = 1;
+        for (node = leaf; node != stop; node = node->parent) {
+            combined = node->combine(combined);
+            path.push_back(node);
+        }
+        long prior = stop->op(combined);
+        while (!path.empty()) {
+            path.back()->distribute(prior);
+            path.pop_back();
+        }
+        return prior;
+    }
+
+    void increment(int thread) {
+        getAndIncrement(thread);
+    }
+
+    long read() const {
+        Node& root = nodes[0];
+        std::lock_guard<std::mutex> lock(root.mtx);
+        return root.result;
+    }
+};
+
+// Пропускная способность увеличений и цена чтения для каждого счётчика
+// при 1, 2, 4 ... maxThreads потоках
+class CounterTest {
+private:
+    int maxThreads;
+    int incrementsPerThread;
+
+    struct Result {
+        double incrementsPerSec = 0;
+        double readNs = 0;
+        bool exact = true;
+    };
+
+    template <typename Counter>
+    Result run(const std::string& name, int threads) {
+        Counter counter(threads);
+        std::vector<std::thread> team;
+        std::vector<CpuUsage> cpu(threads);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int t = 0; t < threads; ++t) {
+            team.emplace_back([&counter, &cpu, &name, t, this]() {
+                CpuUsage cpuStart = CpuUsage::thisThread();
+                RACE_TRACE_PHASE_BEGIN("count " + name);
+                for (int j = 0; j < incrementsPerThread; ++j) {
+                    counter.increment(t);
+                }
+                RACE_TRACE_PHASE_END("count " + name);
+                cpu[t] = CpuUsage::thisThread() - cpuStart;
+            });
+        }
+        for (auto& th : team) {
+            th.join();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        RunEfficiency efficiency = RunEfficiency::fromThreads(seconds, 1LL * threads * incrementsPerThread, cpu);
+
+        // Цена чтения - в покое, после всех увеличений
+        const int reads = 100000;
+        long sink = 0;
+        auto r0 = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < reads; ++i) {
+            sink += counter.read();
+        }
+        auto r1 = std::chrono::high_resolution_clock::now();
+
+        Result result;
+        result.incrementsPerSec = efficiency.throughput();
+        result.readNs = std::chrono::duration<double, std::nano>(r1 - r0).count() / reads;
+        result.exact = (sink / reads == 1LL * threads * incrementsPerThread);
+
+        std::cout << name << " x" << threads << " - " << static_cast<long long>(result.incrementsPerSec)
+                  << " inc/sec, read " << std::fixed << std::setprecision(1) << result.readNs << " ns"
+                  << std::defaultfloat << (result.exact ? "" : ", WRONG TOTAL") << "\n";
+        efficiency.print();
+        return result;
+    }
+
+public:
+    CounterTest(int threads = 64, int increments = 100000)
+        : maxThreads(threads), incrementsPerThread(increments) {}
+
+    void runAllTests() {
+        std::cout << "=== Counter Tests ===\n";
+        std::cout << "Max threads: " << maxThreads << ", Increments per thread: " << incrementsPerThread << "\n\n";
+
+        std::vector<int> threadCounts;
+        for (int t = 1; t < maxThreads; t *= 2) {
+            threadCounts.push_back(t);
+        }
+        threadCounts.push_back(maxThreads);
+
+        const char* names[] = {"atomic fetch_add", "mutex", "padded shards", "per-CPU", "combining tree"};
+        std::vector<Result> results[5];
+        for (int t : threadCounts) {
+            results[0].push_back(run<AtomicCounter>(names[0], t));
+            results[1].push_back(run<MutexCounter>(names[1], t));
+            results[2].push_back(run<ShardedCounter>(names[2], t));
+            results[3].push_back(run<PerCpuCounter>(names[3], t));
+            results[4].push_back(run<CombiningTreeCounter>(names[4], t));
+        }
+
+        std::cout << "\n=== Counters: Minc/s (read ns) ===\n";
+        std::cout << std::left << std::setw(18) << "threads" << std::right;
+        for (int t : threadCounts) {
+            std::cout << std::setw(16) << t;
+        }
+        std::cout << "\n";
+        for (int v = 0; v < 5; ++v) {
+            std::cout << std::left << std::setw(18) << names[v] << std::right << std::fixed;
+            for (const auto& r : results[v]) {
+                std::cout << std::setw(8) << std::setprecision(2) << r.incrementsPerSec / 1e6
+                          << " (" << std::setw(4) << std::setprecision(0) << r.readNs << ")";
+            }
+            std::cout << std::defaultfloat << "\n";
+        }
+    }
+};
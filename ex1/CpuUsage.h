@@ -0,0 +1,92 @@
+#pragma once
+
+#include <sys/resource.h>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+// Учёт процессорного времени потока через getrusage(RUSAGE_THREAD).
+// Нужен, чтобы сравнивать крутящиеся и блокирующиеся примитивы не только по
+// времени прогона, но и по тому, сколько ядер они при этом сожгли.
+struct CpuUsage {
+    double userSec = 0;
+    double sysSec = 0;
+    long voluntarySwitches = 0;
+    long involuntarySwitches = 0;
+
+    static CpuUsage thisThread() {
+        rusage ru{};
+        getrusage(RUSAGE_THREAD, &ru);
+        CpuUsage u;
+        u.userSec = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6;
+        u.sysSec = ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+        u.voluntarySwitches = ru.ru_nvcsw;
+        u.involuntarySwitches = ru.ru_nivcsw;
+        return u;
+    }
+
+    double cpuSec() const { return userSec + sysSec; }
+
+    CpuUsage operator-(const CpuUsage& other) const {
+        CpuUsage u;
+        u.userSec = userSec - other.userSec;
+        u.sysSec = sysSec - other.sysSec;
+        u.voluntarySwitches = voluntarySwitches - other.voluntarySwitches;
+        u.involuntarySwitches = involuntarySwitches - other.involuntarySwitches;
+        return u;
+    }
+
+    CpuUsage& operator+=(const CpuUsage& other) {
+        userSec += other.userSec;
+        sysSec += other.sysSec;
+        voluntarySwitches += other.voluntarySwitches;
+        involuntarySwitches += other.involuntarySwitches;
+        return *this;
+    }
+};
+
+// Итог одного прогона: стена, суммарный CPU всех потоков и число полезных захватов
+struct RunEfficiency {
+    double wallSec = 0;
+    long long acquisitions = 0;
+    CpuUsage cpu;
+
+    static RunEfficiency fromThreads(double wallSeconds, long long acquired, const std::vector<CpuUsage>& perThread) {
+        RunEfficiency e;
+        e.wallSec = wallSeconds;
+        e.acquisitions = acquired;
+        for (const auto& u : perThread) {
+            e.cpu += u;
+        }
+        return e;
+    }
+
+    double throughput() const {
+        return wallSec > 0 ? acquisitions / wallSec : 0;
+    }
+
+    // Сколько ядер в среднем было занято прогоном
+    double coresBusy() const {
+        return wallSec > 0 ? cpu.cpuSec() / wallSec : 0;
+    }
+
+    double cpuSecPerMillion() const {
+        return acquisitions > 0 ? cpu.cpuSec() * 1e6 / acquisitions : 0;
+    }
+
+    // Пропускная способность на одно занятое ядро (захватов на CPU-секунду)
+    double efficiency() const {
+        return cpu.cpuSec() > 0 ? acquisitions / cpu.cpuSec() : 0;
+    }
+
+    void print(std::ostream& out = std::cout, const std::string& indent = "    ") const {
+        out << indent << std::fixed << std::setprecision(3)
+            << "CPU user " << cpu.userSec << "s, sys " << cpu.sysSec << "s"
+            << ", ctx vol/invol " << cpu.voluntarySwitches << "/" << cpu.involuntarySwitches
+            << ", cores busy " << coresBusy()
+            << ", " << cpuSecPerMillion() << " CPU-s per 1M acq"
+            << ", efficiency " << std::setprecision(0) << efficiency() << " acq/CPU-s\n"
+            << std::defaultfloat;
+    }
+};
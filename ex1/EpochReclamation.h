@@ -0,0 +1,212 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+// Эпохальное освобождение памяти (EBR) для lock-free структур.
+// Поток, читающий разделяемые узлы, держит EpochGuard. Снятый с структуры узел
+// не удаляется сразу, а откладывается (retire) в корзину текущей эпохи потока.
+// Глобальная эпоха продвигается, когда все активные потоки её увидели; корзина
+// эпохи e освобождается, когда эпоха дошла до e+3: читатель, вошедший в e+1, мог
+// ещё видеть узел, и только продвижение e+2 -> e+3 гарантирует, что он вышел.
+//
+// Домен один на процесс (как LockProfiler и Tracer): записи потоков - в
+// фиксированном массиве, поток занимает запись при первом обращении и
+// освобождает при выходе, отдавая неосвобождённые узлы в общий список.
+class EpochDomain {
+private:
+    static constexpr int kMaxThreads = 256;
+    static constexpr int kAdvanceEvery = 64; // попытка продвинуть эпоху каждые N retire
+
+    struct Retired {
+        void* ptr;
+        void (*deleter)(void*);
+    };
+
+    struct alignas(64) Record {
+        std::atomic<bool> used{false};
+        std::atomic<bool> active{false};
+        std::atomic<std::uint64_t> epoch{0};
+        // Ниже - только поток-владелец
+        std::array<std::vector<Retired>, 3> bags;
+        std::array<std::uint64_t, 3> bagEpoch{};
+        long pending = 0;
+        long peakPending = 0;
+        int sinceAdvance = 0;
+        int nesting = 0;
+    };
+
+    struct Orphan {
+        std::uint64_t epoch;
+        Retired retired;
+    };
+
+    struct RecordLease {
+        Record* record;
+        RecordLease() : record(EpochDomain::instance().acquireRecord()) {}
+        ~RecordLease() { EpochDomain::instance().releaseRecord(record); }
+    };
+
+    std::atomic<std::uint64_t> globalEpoch{3};
+    Record records[kMaxThreads];
+    std::atomic<long> retiredTotal{0};
+    std::atomic<long> freedTotal{0};
+    std::atomic<long> peakPendingSum{0};
+    std::mutex orphanMutex;
+    std::vector<Orphan> orphans;
+
+    Record* acquireRecord() {
+        for (auto& r : records) {
+            bool expected = false;
+            if (!r.used.load(std::memory_order_relaxed) &&
+                r.used.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                return &r;
+            }
+        }
+        throw std::runtime_error("EpochDomain: too many threads");
+    }
+
+    void releaseRecord(Record* r) {
+        {
+            std::lock_guard<std::mutex> lock(orphanMutex);
+            for (int b = 0; b < 3; ++b) {
+                for (const auto& item : r->bags[b]) {
+                    orphans.push_back({r->bagEpoch[b], item});
+                }
+                r->bags[b].clear();
+            }
+        }
+        peakPendingSum.fetch_add(r->peakPending, std::memory_order_relaxed);
+        r->pending = 0;
+        r->peakPending = 0;
+        r->sinceAdvance = 0;
+        r->active.store(false, std::memory_order_release);
+        r->used.store(false, std::memory_order_release);
+    }
+
+    Record& self() {
+        static thread_local RecordLease lease;
+        return *lease.record;
+    }
+
+    void freeBag(Record& r, int b) {
+        for (const auto& item : r.bags[b]) {
+            item.deleter(item.ptr);
+        }
+        long n = static_cast<long>(r.bags[b].size());
+        r.pending -= n;
+        freedTotal.fetch_add(n, std::memory_order_relaxed);
+        r.bags[b].clear();
+    }
+
+    // Продвинуть эпоху, если все активные потоки уже в текущей
+    void tryAdvance() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::uint64_t e = globalEpoch.load(std::memory_order_relaxed);
+        for (auto& r : records) {
+            if (r.used.load(std::memory_order_acquire) && r.active.load(std::memory_order_acquire) &&
+                r.epoch.load(std::memory_order_acquire) != e) {
+                return;
+            }
+        }
+        globalEpoch.compare_exchange_strong(e, e + 1, std::memory_order_acq_rel);
+
+        // Сироты завершившихся потоков - тем же правилом, что и корзины (эпоха e+3)
+        std::unique_lock<std::mutex> lock(orphanMutex, std::try_to_lock);
+        if (lock.owns_lock() && !orphans.empty()) {
+            std::uint64_t now = globalEpoch.load(std::memory_order_acquire);
+            size_t kept = 0;
+            for (auto& o : orphans) {
+                if (o.epoch + 3 <= now) {
+                    o.retired.deleter(o.retired.ptr);
+                    freedTotal.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    orphans[kept++] = o;
+                }
+            }
+            orphans.resize(kept);
+        }
+    }
+
+    EpochDomain() = default;
+
+public:
+    // Домен не разрушается: узлы в корзинах могут пережить static-деструкторы
+    static EpochDomain& instance() {
+        static EpochDomain* domain = new EpochDomain();
+        return *domain;
+    }
+
+    void enter() {
+        Record& r = self();
+        if (r.nesting++ > 0) {
+            return;
+        }
+        r.active.store(true, std::memory_order_relaxed);
+        // Пока поток не был активен, эпоха могла уйти вперёд и не раз (вытеснение
+        // между чтением и объявлением). Объявлять можно только эпоху, которая всё
+        // ещё текущая после барьера: иначе retire положит узлы в слишком старую корзину.
+        std::uint64_t e = globalEpoch.load(std::memory_order_relaxed);
+        for (;;) {
+            r.epoch.store(e, std::memory_order_relaxed);
+            // Объявление активности должно стать видно раньше чтения узлов
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::uint64_t now = globalEpoch.load(std::memory_order_relaxed);
+            if (now == e) {
+                break;
+            }
+            e = now;
+        }
+    }
+
+    void exit() {
+        Record& r = self();
+        if (--r.nesting == 0) {
+            r.active.store(false, std::memory_order_release);
+        }
+    }
+
+    // Вызывать внутри EpochGuard, после того как узел снят со структуры
+    template <typename T>
+    void retire(T* ptr) {
+        Record& r = self();
+        std::uint64_t e = r.epoch.load(std::memory_order_relaxed);
+        int b = static_cast<int>(e % 3);
+        if (r.bagEpoch[b] != e) {
+            // В корзине узлы эпохи e-3 или старше - их уже никто не видит
+            freeBag(r, b);
+            r.bagEpoch[b] = e;
+        }
+        r.bags[b].push_back({ptr, [](void* p) { delete static_cast<T*>(p); }});
+        retiredTotal.fetch_add(1, std::memory_order_relaxed);
+        r.peakPending = std::max(r.peakPending, ++r.pending);
+        if (++r.sinceAdvance >= kAdvanceEvery) {
+            r.sinceAdvance = 0;
+            tryAdvance();
+        }
+    }
+
+    // Статистика: отложено всего, освобождено всего, сумма пиков отложенных по потокам
+    long retired() const { return retiredTotal.load(std::memory_order_relaxed); }
+    long freed() const { return freedTotal.load(std::memory_order_relaxed); }
+    long peakPending() const { return peakPendingSum.load(std::memory_order_relaxed); }
+
+    void resetStats() {
+        retiredTotal.store(0, std::memory_order_relaxed);
+        freedTotal.store(0, std::memory_order_relaxed);
+        peakPendingSum.store(0, std::memory_order_relaxed);
+    }
+};
+
+class EpochGuard {
+public:
+    EpochGuard() { EpochDomain::instance().enter(); }
+    ~EpochGuard() { EpochDomain::instance().exit(); }
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+
+// Считающий семафор без мьютекса.
+// Быстрый путь - один CAS по счётчику разрешений. В ядро (futex через
+// atomic::wait) поток уходит только когда разрешений нет, а release()
+// будит кого-то только если есть спящие ожидающие.
+class FastSemaphore {
+private:
+    std::atomic<int> count;
+    std::atomic<int> waiters{0};
+
+public:
+    explicit FastSemaphore(int initial = 1) : count(initial) {}
+
+    FastSemaphore(const FastSemaphore&) = delete;
+    FastSemaphore& operator=(const FastSemaphore&) = delete;
+
+    bool try_acquire() {
+        int c = count.load(std::memory_order_relaxed);
+        while (c > 0) {
+            if (count.compare_exchange_weak(c, c - 1,
+                    std::memory_order_acquire, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void acquire() {
+        if (try_acquire()) {
+            return;
+        }
+
+        // Медленный путь: регистрируемся как ожидающий до проверки счётчика,
+        // иначе release() может не увидеть нас и пропустить notify.
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        for (;;) {
+            int c = count.load(std::memory_order_seq_cst);
+            if (c > 0) {
+                if (count.compare_exchange_weak(c, c - 1,
+                        std::memory_order_acquire, std::memory_order_relaxed)) {
+                    break;
+                }
+                continue;
+            }
+            count.wait(0, std::memory_order_relaxed);
+        }
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void release(int n = 1) {
+        count.fetch_add(n, std::memory_order_seq_cst);
+        // Системный вызов только если кто-то действительно спит
+        if (waiters.load(std::memory_order_seq_cst) > 0) {
+            if (n == 1) {
+                count.notify_one();
+            } else {
+                count.notify_all();
+            }
+        }
+    }
+};
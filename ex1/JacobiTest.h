@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "BspEngine.h"
+#include "Tracer.h"
+
+// Параллельный метод Якоби для уравнения Лапласа на сетке n x n как нагрузка
+// для BspEngine: фаза - один шаг сглаживания из буфера в буфер, шаг
+// завершения - сумма невязок потоков и проверка сходимости.
+//
+// Классический вариант считает локальную невязку до барьера. В раздельном
+// (split-phase) варианте поток приходит на барьер сразу после записи своих
+// строк, а невязку считает уже во время ожидания; редукция поэтому отстаёт
+// на одну фазу. Невязки хранятся в двух наборах ячеек по чётности фазы,
+// чтобы шаг завершения фазы k не читал ячейки, которые пишутся в фазе k.
+class JacobiTest {
+private:
+    int numWorkers;
+    int n;
+    int maxPhases;
+    double tolerance;
+
+    void run(bool splitPhase) {
+        std::vector<double> a(static_cast<size_t>(n) * n, 0.0);
+        for (int x = 0; x < n; ++x) {
+            a[x] = 1.0; // верхняя граница нагрета
+        }
+        std::vector<double> b = a;
+        std::vector<double> residual[2] = {std::vector<double>(numWorkers, 0.0),
+                                           std::vector<double>(numWorkers, 0.0)};
+        double lastResidual = 0;
+
+        BspEngine engine(numWorkers);
+        std::string name = splitPhase ? "Jacobi split-phase" : "Jacobi classic";
+
+        auto kernel = [&](BspEngine::Worker& worker) {
+            const std::vector<double>& src = worker.phase % 2 == 0 ? a : b;
+            std::vector<double>& dst = worker.phase % 2 == 0 ? b : a;
+            auto [begin, end] = worker.partition(n - 2);
+
+            RACE_TRACE_PHASE_BEGIN(name);
+            for (size_t y = begin + 1; y < end + 1; ++y) {
+                for (int x = 1; x < n - 1; ++x) {
+                    size_t i = y * n + x;
+                    dst[i] = 0.25 * (src[i - 1] + src[i + 1] + src[i - n] + src[i + n]);
+                }
+            }
+            RACE_TRACE_PHASE_END(name);
+
+            if (splitPhase) {
+                // Чужие потоки читают только наши новые строки из dst - дальше их не меняем
+                worker.arrive();
+            }
+            double local = 0;
+            for (size_t y = begin + 1; y < end + 1; ++y) {
+                for (int x = 1; x < n - 1; ++x) {
+                    size_t i = y * n + x;
+                    local += std::fabs(dst[i] - src[i]);
+                }
+            }
+            residual[worker.phase % 2][worker.id] = local;
+        };
+
+        auto completion = [&](int phase) {
+            // Классика: невязка этой фазы; split-phase: предыдущей
+            int slot = splitPhase ? phase - 1 : phase;
+            if (slot < 0) {
+                return true;
+            }
+            double total = 0;
+            for (double r : residual[slot % 2]) {
+                total += r;
+            }
+            lastResidual = total;
+            return total > tolerance;
+        };
+
+        BspEngine::Stats stats = engine.run(maxPhases, kernel, completion);
+
+        long long idleSum = 0;
+        long long idleMax = 0;
+        for (long long ns : stats.workerIdleNs) {
+            idleSum += ns;
+            idleMax = std::max(idleMax, ns);
+        }
+        double idleAvgMs = idleSum / 1e6 / numWorkers;
+
+        std::cout << name << " - " << stats.phases << " phases in "
+                  << static_cast<long long>(stats.wallSec * 1e6) << " microseconds"
+                  << ", " << std::fixed << std::setprecision(1) << stats.avgPhaseUs() << " us/phase"
+                  << ", residual " << std::scientific << std::setprecision(3) << lastResidual
+                  << std::defaultfloat << "\n";
+        std::cout << "    barrier idle per worker: avg " << std::fixed << std::setprecision(2) << idleAvgMs
+                  << " ms, max " << idleMax / 1e6 << " ms (" << std::setprecision(1)
+                  << 100.0 * idleAvgMs / 1e3 / std::max(stats.wallSec, 1e-9) << "% of wall) |";
+        for (long long ns : stats.workerIdleNs) {
+            std::cout << " " << std::setprecision(2) << ns / 1e6;
+        }
+        std::cout << std::defaultfloat << "\n";
+    }
+
+public:
+    JacobiTest(int workers, int gridSize = 512, int phases = 200, double tol = 1e-9)
+        : numWorkers(workers), n(gridSize), maxPhases(phases), tolerance(tol) {}
+
+    void runAllTests() {
+        std::cout << "=== BSP Jacobi Tests ===\n";
+        std::cout << "Workers: " << numWorkers << ", Grid: " << n << "x" << n
+                  << ", Max phases: " << maxPhases << "\n\n";
+        run(false);
+        run(true);
+    }
+};
@@ -0,0 +1,328 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include "Tracer.h"
+
+// Профилировщик конкуренции за блокировки.
+// Каждое место захвата (site) имеет имя и свою статистику. Счётчик захватов
+// и признак конкуренции (не удался try_lock) пишутся всегда, а время ожидания
+// и удержания замеряется только на каждом sampleEvery-м захвате потока,
+// чтобы профилирование можно было не выключать на длинных прогонах.
+struct LockSiteStats {
+    std::string name;
+    std::atomic<long long> acquisitions{0};
+    std::atomic<long long> contended{0};
+    std::atomic<long long> sampled{0};
+    std::atomic<long long> waitNs{0};     // сумма по выборке
+    std::atomic<long long> maxWaitNs{0};
+    std::atomic<long long> holdNs{0};     // сумма по выборке
+    std::atomic<int> waiters{0};          // сейчас ждут
+    std::atomic<int> peakWaiters{0};
+    // У примитива нет try_lock: конкуренция видна только в выборке (contended из sampled),
+    // а число ждущих не определить
+    std::atomic<bool> sampledContention{false};
+
+    explicit LockSiteStats(std::string siteName) : name(std::move(siteName)) {}
+
+    static void updateMax(std::atomic<long long>& target, long long value) {
+        long long current = target.load(std::memory_order_relaxed);
+        while (value > current &&
+               !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Оценка полного времени ожидания с учётом частоты выборки
+    double estimatedWaitNs() const {
+        long long s = sampled.load();
+        return s == 0 ? 0.0 : static_cast<double>(waitNs.load()) * acquisitions.load() / s;
+    }
+
+    void reset() {
+        acquisitions = 0;
+        contended = 0;
+        sampled = 0;
+        waitNs = 0;
+        maxWaitNs = 0;
+        holdNs = 0;
+        waiters = 0;
+        peakWaiters = 0;
+    }
+};
+
+class LockProfiler {
+private:
+    std::mutex registryMutex;
+    std::deque<LockSiteStats> sites; // deque: адреса элементов стабильны
+    std::atomic<bool> enabled{false};
+    std::atomic<int> sampleEvery{16};
+
+public:
+    static LockProfiler& instance() {
+        static LockProfiler profiler;
+        return profiler;
+    }
+
+    static bool isEnabled() {
+        return instance().enabled.load(std::memory_order_relaxed);
+    }
+
+    void enable(bool on = true, int everyNth = 16) {
+        enabled = on;
+        sampleEvery = std::max(1, everyNth);
+    }
+
+    int samplingPeriod() const {
+        return sampleEvery.load(std::memory_order_relaxed);
+    }
+
+    // Одно и то же имя - одна статистика, даже между разными прогонами
+    LockSiteStats& site(const std::string& name) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (auto& s : sites) {
+            if (s.name == name) {
+                return s;
+            }
+        }
+        return sites.emplace_back(name);
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (auto& s : sites) {
+            s.reset();
+        }
+    }
+
+    // Рейтинг мест захвата по оценке суммарного ожидания
+    void report(std::ostream& out = std::cout) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        std::vector<const LockSiteStats*> ranked;
+        for (const auto& s : sites) {
+            if (s.acquisitions.load() > 0) {
+                ranked.push_back(&s);
+            }
+        }
+        std::sort(ranked.begin(), ranked.end(), [](const LockSiteStats* a, const LockSiteStats* b) {
+            return a->estimatedWaitNs() > b->estimatedWaitNs();
+        });
+
+        out << "\n=== Lock contention report (sampling 1/" << samplingPeriod() << ") ===\n";
+        out << std::left << std::setw(44) << "Site"
+            << std::right << std::setw(12) << "Acquired"
+            << std::setw(10) << "Contend%"
+            << std::setw(14) << "Wait ms(est)"
+            << std::setw(14) << "Max wait us"
+            << std::setw(14) << "Avg hold us"
+            << std::setw(8) << "Peak W" << "\n";
+
+        out << std::fixed << std::setprecision(2);
+        bool anyBySample = false;
+        for (const auto* s : ranked) {
+            long long acq = s->acquisitions.load();
+            long long smp = s->sampled.load();
+            bool bySample = s->sampledContention.load();
+            anyBySample = anyBySample || bySample;
+            long long base = bySample ? smp : acq;
+            std::ostringstream contend;
+            contend << std::fixed << std::setprecision(2)
+                    << (base ? 100.0 * s->contended.load() / base : 0.0) << (bySample ? "*" : "");
+            out << std::left << std::setw(44) << s->name
+                << std::right << std::setw(12) << acq
+                << std::setw(10) << contend.str()
+                << std::setw(14) << s->estimatedWaitNs() / 1e6
+                << std::setw(14) << s->maxWaitNs.load() / 1e3
+                << std::setw(14) << (smp ? s->holdNs.load() / 1e3 / smp : 0.0)
+                << std::setw(8) << (bySample ? std::string("n/a") : std::to_string(s->peakWaiters.load())) << "\n";
+        }
+        if (anyBySample) {
+            out << "* no try_lock: Contend% is over sampled acquisitions, waiters unknown\n";
+        }
+        out << std::defaultfloat;
+    }
+};
+
+namespace lock_profiler_detail {
+
+template <typename L> concept HasLock = requires(L& l) { l.lock(); l.unlock(); };
+template <typename L> concept HasAcquire = requires(L& l) { l.acquire(); l.release(); };
+template <typename L> concept HasEnter = requires(L& l) { l.enter(); l.exit(); };
+template <typename L> concept HasTryLock = requires(L& l) { { l.try_lock() } -> std::convertible_to<bool>; };
+template <typename L> concept HasTryAcquire = requires(L& l) { { l.try_acquire() } -> std::convertible_to<bool>; };
+
+// Приводим lock/unlock, acquire/release и enter/exit к одному виду
+template <typename L>
+void doLock(L& l) {
+    if constexpr (HasLock<L>) {
+        l.lock();
+    } else if constexpr (HasAcquire<L>) {
+        l.acquire();
+    } else {
+        static_assert(HasEnter<L>, "unsupported lock type");
+        l.enter();
+    }
+}
+
+template <typename L>
+void doUnlock(L& l) {
+    if constexpr (HasLock<L>) {
+        l.unlock();
+    } else if constexpr (HasAcquire<L>) {
+        l.release();
+    } else {
+        l.exit();
+    }
+}
+
+inline bool sampleThisAcquisition() {
+    static thread_local unsigned counter = 0;
+    return counter++ % static_cast<unsigned>(LockProfiler::instance().samplingPeriod()) == 0;
+}
+
+} // namespace lock_profiler_detail
+
+// Обёртка над примитивом с именованным местом захвата.
+// Если профилировщик выключен - только одна проверка флага сверх самого примитива.
+// Используется для взаимного исключения: время начала удержания хранится в обёртке.
+template <typename Lock>
+class ProfiledLock {
+private:
+    Lock& inner;
+    LockSiteStats& stats;
+    std::chrono::steady_clock::time_point holdStart{};
+    bool holdSampled = false;
+
+public:
+    ProfiledLock(Lock& lock, const std::string& siteName)
+        : inner(lock), stats(LockProfiler::instance().site(siteName)) {
+        using namespace lock_profiler_detail;
+        if constexpr (!HasTryLock<Lock> && !HasTryAcquire<Lock>) {
+            stats.sampledContention.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    ProfiledLock(const ProfiledLock&) = delete;
+    ProfiledLock& operator=(const ProfiledLock&) = delete;
+
+    Lock& native() { return inner; }
+
+    void lock() {
+        using namespace lock_profiler_detail;
+        RACE_TRACE_LOCK_REQUEST(stats.name.c_str());
+        if (!LockProfiler::isEnabled()) {
+            doLock(inner);
+            RACE_TRACE_ACQUIRED(stats.name.c_str());
+            return;
+        }
+
+        bool sample = sampleThisAcquisition();
+        auto t0 = sample ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+
+        if constexpr (HasTryLock<Lock> || HasTryAcquire<Lock>) {
+            bool gotFast = false;
+            if constexpr (HasTryLock<Lock>) {
+                gotFast = inner.try_lock();
+            } else {
+                gotFast = inner.try_acquire();
+            }
+            if (!gotFast) {
+                int w = stats.waiters.fetch_add(1, std::memory_order_relaxed) + 1;
+                int peak = stats.peakWaiters.load(std::memory_order_relaxed);
+                while (w > peak && !stats.peakWaiters.compare_exchange_weak(peak, w, std::memory_order_relaxed)) {
+                }
+                doLock(inner);
+                stats.waiters.fetch_sub(1, std::memory_order_relaxed);
+                stats.contended.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else {
+            // Без try_lock конкуренцию видно только по выборке (ожидание дольше 1 мкс),
+            // ждущих не отличить от захвативших сразу - их не считаем
+            doLock(inner);
+        }
+
+        stats.acquisitions.fetch_add(1, std::memory_order_relaxed);
+        holdSampled = sample;
+        if (sample) {
+            holdStart = std::chrono::steady_clock::now();
+            long long wait = std::chrono::duration_cast<std::chrono::nanoseconds>(holdStart - t0).count();
+            if constexpr (!HasTryLock<Lock> && !HasTryAcquire<Lock>) {
+                if (wait > 1000) {
+                    stats.contended.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            stats.sampled.fetch_add(1, std::memory_order_relaxed);
+            stats.waitNs.fetch_add(wait, std::memory_order_relaxed);
+            LockSiteStats::updateMax(stats.maxWaitNs, wait);
+        }
+        RACE_TRACE_ACQUIRED(stats.name.c_str());
+    }
+
+    void unlock() {
+        RACE_TRACE_RELEASED(stats.name.c_str());
+        if (holdSampled) {
+            holdSampled = false;
+            auto hold = std::chrono::steady_clock::now() - holdStart;
+            stats.holdNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(hold).count(),
+                                   std::memory_order_relaxed);
+        }
+        lock_profiler_detail::doUnlock(inner);
+    }
+
+    // Синонимы, чтобы обёртка подходила туда, где ждут семафор или монитор
+    void acquire() { lock(); }
+    void release() { unlock(); }
+    void enter() { lock(); }
+    void exit() { unlock(); }
+};
+
+// Профилирование барьера: ожидание в arrive_and_wait, удержания нет
+template <typename Barrier>
+class ProfiledBarrier {
+private:
+    Barrier& inner;
+    LockSiteStats& stats;
+
+public:
+    ProfiledBarrier(Barrier& barrier, const std::string& siteName)
+        : inner(barrier), stats(LockProfiler::instance().site(siteName)) {}
+
+    void arrive_and_wait() {
+        RACE_TRACE_LOCK_REQUEST(stats.name.c_str());
+        if (!LockProfiler::isEnabled()) {
+            inner.arrive_and_wait();
+            RACE_TRACE_ACQUIRED(stats.name.c_str());
+            RACE_TRACE_RELEASED(stats.name.c_str());
+            return;
+        }
+
+        bool sample = lock_profiler_detail::sampleThisAcquisition();
+        auto t0 = sample ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+        int w = stats.waiters.fetch_add(1, std::memory_order_relaxed) + 1;
+        int peak = stats.peakWaiters.load(std::memory_order_relaxed);
+        while (w > peak && !stats.peakWaiters.compare_exchange_weak(peak, w, std::memory_order_relaxed)) {
+        }
+        inner.arrive_and_wait();
+        stats.waiters.fetch_sub(1, std::memory_order_relaxed);
+        stats.acquisitions.fetch_add(1, std::memory_order_relaxed);
+        stats.contended.fetch_add(1, std::memory_order_relaxed);
+        if (sample) {
+            long long wait = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - t0).count();
+            stats.sampled.fetch_add(1, std::memory_order_relaxed);
+            stats.waitNs.fetch_add(wait, std::memory_order_relaxed);
+            LockSiteStats::updateMax(stats.maxWaitNs, wait);
+        }
+        RACE_TRACE_ACQUIRED(stats.name.c_str());
+        RACE_TRACE_RELEASED(stats.name.c_str());
+    }
+};
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <semaphore>
+#include <string>
+#include "FastSemaphore.h"
+#include "SpinWait.h"
+
+// Адаптеры примитивов с единым интерфейсом lock()/unlock()/try_lock(),
+// чтобы их можно было гонять в одном шаблонном тесте и оборачивать профилировщиком.
+
+// std::counting_semaphore с одним разрешением (у него нет конструктора по умолчанию)
+class StdSemaphoreLock {
+private:
+    std::counting_semaphore<1000> sem{1};
+public:
+    void lock() { sem.acquire(); }
+    bool try_lock() { return sem.try_acquire(); }
+    void unlock() { sem.release(); }
+};
+
+// SpinLock на atomic_flag: крутимся на test_and_set.
+// Ожидание - SpinWait с политикой места; по умолчанию чистый спин с PAUSE.
+class TasSpinLock {
+private:
+    std::atomic_flag flag = ATOMIC_FLAG_INIT;
+    SpinPolicy policy;
+public:
+    explicit TasSpinLock(const SpinPolicy& spinPolicy = SpinPolicy::spinOnly()) : policy(spinPolicy) {}
+
+    void lock() {
+        SpinWait spin(policy);
+        while (flag.test_and_set(std::memory_order_acquire)) {
+            spin.spinOnce();
+        }
+    }
+
+    bool try_lock() {
+        return !flag.test_and_set(std::memory_order_acquire);
+    }
+
+    void unlock() {
+        flag.clear(std::memory_order_release);
+    }
+};
+
+// SpinLock с yield после каждой неудачной попытки (прежний spinwait_worker из test.cpp)
+class YieldSpinLock {
+private:
+    std::atomic_flag flag = ATOMIC_FLAG_INIT;
+public:
+    void lock() {
+        SpinWait spin(SpinPolicy::yieldOnly());
+        while (flag.test_and_set(std::memory_order_acquire)) {
+            spin.spinOnce();
+        }
+    }
+
+    bool try_lock() {
+        return !flag.test_and_set(std::memory_order_acquire);
+    }
+
+    void unlock() {
+        flag.clear(std::memory_order_release);
+    }
+};
+
+// Прежний SpinWait из testWithSpinWait, оставлен для сравнения со SpinWaitLock.
+// yield делается только на каждом сотом захвате потока (j % 100 == 0), а не по
+// числу неудачных попыток: такой захват уступает на каждой попытке, остальные не уступают никогда.
+class ModuloYieldSpinLock {
+private:
+    std::atomic<bool> flag{false};
+public:
+    void lock() {
+        static thread_local unsigned acquisitions = 0;
+        bool mayYield = (acquisitions++ % 100 == 0);
+        bool expected = false;
+        while (!flag.compare_exchange_weak(expected, true,
+                std::memory_order_acquire, std::memory_order_relaxed)) {
+            expected = false;
+            // Spin wait with potential yield
+            if (mayYield) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    bool try_lock() {
+        bool expected = false;
+        return flag.compare_exchange_strong(expected, true,
+                std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock() {
+        flag.store(false, std::memory_order_release);
+    }
+};
+
+// SpinWait-блокировка: фазы ожидания задаёт SpinPolicy (пауза -> yield -> сон ->
+// парковка на futex). Состояние как у futex-мьютекса Дреппера: 0 - свободна,
+// 1 - занята, 2 - занята и, возможно, есть спящие; unlock() делает системный
+// вызов только в состоянии 2.
+class SpinWaitLock {
+private:
+    std::atomic<int> state{0};
+    SpinPolicy policy;
+public:
+    explicit SpinWaitLock(const SpinPolicy& spinPolicy = SpinPolicy::escalating()) : policy(spinPolicy) {}
+
+    void lock() {
+        int expected = 0;
+        if (state.compare_exchange_strong(expected, 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            return;
+        }
+        SpinWait spin(policy);
+        for (;;) {
+            expected = 0;
+            if (state.load(std::memory_order_relaxed) == 0 &&
+                state.compare_exchange_weak(expected, 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return;
+            }
+            if (!spin.spinOnce()) {
+                break;
+            }
+        }
+        // Парковка: помечаем, что есть спящие, и засыпаем, пока блокировка занята
+        while (state.exchange(2, std::memory_order_acquire) != 0) {
+            state.wait(2, std::memory_order_relaxed);
+        }
+    }
+
+    bool try_lock() {
+        int expected = 0;
+        return state.compare_exchange_strong(expected, 1,
+                std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock() {
+        if (state.exchange(0, std::memory_order_release) == 2) {
+            state.notify_one();
+        }
+    }
+};
+
+// Монитор (условная переменная + мьютекс) из testWithMonitor:
+// мьютекс удерживается всё время критической секции.
+class CondVarMonitorLock {
+private:
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool ready = true;
+public:
+    void lock() {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this]() { return ready; });
+        ready = false;
+        lock.release();
+    }
+
+    bool try_lock() {
+        if (!mtx.try_lock()) {
+            return false;
+        }
+        if (!ready) {
+            mtx.unlock();
+            return false;
+        }
+        ready = false;
+        return true;
+    }
+
+    void unlock() {
+        ready = true;
+        mtx.unlock();
+        cv.notify_one();
+    }
+};
+
+// Вызывает f.template operator()<Lock>(name) для каждого взаимоисключающего
+// примитива из ThreadRaceTest - для развёрток, где нужны все примитивы сразу
+template <typename F>
+void forEachLockPrimitive(F&& f) {
+    f.template operator()<std::mutex>("Mutex");
+    f.template operator()<StdSemaphoreLock>("Semaphore");
+    f.template operator()<FastSemaphore>("FastSemaphore");
+    f.template operator()<TasSpinLock>("SpinLock");
+    f.template operator()<SpinWaitLock>("SpinWait");
+    f.template operator()<CondVarMonitorLock>("Monitor");
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "SpinWait.h"
+
+// Очередная блокировка Меллора-Крамми и Скотта (MCS).
+// Каждый ожидающий крутится на флаге своего узла, а не на общем слове, поэтому
+// при высокой конкуренции освобождение трогает одну чужую кэш-линию, а не все.
+// Порядок захвата - FIFO.
+//
+// Узлы берутся из пула потока, держатель запоминает свой узел в блокировке,
+// так что интерфейс остаётся обычным lock()/unlock() и блокировки можно вкладывать.
+class McsLock {
+private:
+    struct alignas(64) Node {
+        std::atomic<Node*> next{nullptr};
+        std::atomic<bool> locked{false};
+    };
+
+    // После unlock() узел можно сразу переиспользовать. Память узлов не
+    // освобождается: предыдущий держатель мог ещё не выйти из notify_one() по
+    // флагу узла, когда его поток уже завершился. Узлы завершившихся потоков
+    // уходят в общий список и достаются новым потокам.
+    struct NodePool {
+        std::vector<Node*> free;
+
+        static std::mutex& orphanMutex() {
+            static std::mutex m;
+            return m;
+        }
+
+        static std::vector<Node*>& orphans() {
+            static auto* nodes = new std::vector<Node*>();
+            return *nodes;
+        }
+
+        Node* take() {
+            if (free.empty()) {
+                std::lock_guard<std::mutex> lock(orphanMutex());
+                if (orphans().empty()) {
+                    return new Node();
+                }
+                Node* node = orphans().back();
+                orphans().pop_back();
+                return node;
+            }
+            Node* node = free.back();
+            free.pop_back();
+            return node;
+        }
+
+        void give(Node* node) {
+            free.push_back(node);
+        }
+
+        ~NodePool() {
+            std::lock_guard<std::mutex> lock(orphanMutex());
+            orphans().insert(orphans().end(), free.begin(), free.end());
+        }
+    };
+
+    static NodePool& pool() {
+        static thread_local NodePool nodes;
+        return nodes;
+    }
+
+    std::atomic<Node*> tail{nullptr};
+    Node* holder = nullptr; // узел текущего держателя, пишет только он
+    // Ожидание на своём флаге: спин, yield, сон и парковка на futex флага узла
+    SpinPolicy policy;
+
+public:
+    explicit McsLock(const SpinPolicy& spinPolicy = SpinPolicy::escalating()) : policy(spinPolicy) {}
+    McsLock(const McsLock&) = delete;
+    McsLock& operator=(const McsLock&) = delete;
+
+    // Возвращает true, если пришлось встать в очередь за другим потоком
+    bool lockContended() {
+        Node* node = pool().take();
+        node->next.store(nullptr, std::memory_order_relaxed);
+        node->locked.store(true, std::memory_order_relaxed);
+
+        Node* predecessor = tail.exchange(node, std::memory_order_acq_rel);
+        if (predecessor != nullptr) {
+            predecessor->next.store(node, std::memory_order_release);
+            SpinWait spin(policy);
+            spin.waitWhileEquals(node->locked, true);
+        }
+        holder = node;
+        return predecessor != nullptr;
+    }
+
+    void lock() {
+        lockContended();
+    }
+
+    bool try_lock() {
+        Node* node = pool().take();
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* expected = nullptr;
+        if (!tail.compare_exchange_strong(expected, node, std::memory_order_acquire, std::memory_order_relaxed)) {
+            pool().give(node);
+            return false;
+        }
+        holder = node;
+        return true;
+    }
+
+    void unlock() {
+        Node* node = holder;
+        Node* successor = node->next.load(std::memory_order_acquire);
+        if (successor == nullptr) {
+            Node* expected = node;
+            if (tail.compare_exchange_strong(expected, nullptr, std::memory_order_release, std::memory_order_relaxed)) {
+                pool().give(node);
+                return;
+            }
+            // Преемник уже обменял tail, но ещё не связал себя с нами
+            SpinWait spin(SpinPolicy::handoff());
+            successor = spin.waitWhileEquals(node->next, static_cast<Node*>(nullptr));
+        }
+        successor->locked.store(false, std::memory_order_release);
+        successor->locked.notify_one();
+        pool().give(node);
+    }
+};
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+#include "FastSemaphore.h"
+#include "SpinWait.h"
+
+// Ограниченные очереди для режима "производители/потребители".
+// У всех одинаковый интерфейс: блокирующие push()/pop().
+
+// Кольцевой буфер Вьюкова (MPMC, без блокировок).
+// У каждой ячейки свой номер последовательности: производитель ждёт seq == pos,
+// потребитель - seq == pos + 1. Ёмкость округляется до степени двойки.
+template <typename T>
+class VyukovQueue {
+private:
+    struct alignas(64) Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> buffer;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) std::atomic<size_t> dequeuePos{0};
+
+    static size_t roundUpPow2(size_t n) {
+        size_t p = 2;
+        while (p < n) {
+            p <<= 1;
+        }
+        return p;
+    }
+
+public:
+    explicit VyukovQueue(size_t capacity) {
+        size_t size = roundUpPow2(capacity);
+        buffer.reset(new Cell[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; ++i) {
+            buffer[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool try_push(const T& value) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = buffer[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.data = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // очередь полна
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_pop(T& value) {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = buffer[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = cell.data;
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // очередь пуста
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Будить ждущих некому, поэтому без парковки: короткий спин, затем yield
+    void push(const T& value) {
+        SpinWait spin(SpinPolicy::handoff());
+        while (!try_push(value)) {
+            spin.spinOnce();
+        }
+    }
+
+    T pop() {
+        T value;
+        SpinWait spin(SpinPolicy::handoff());
+        while (!try_pop(value)) {
+            spin.spinOnce();
+        }
+        return value;
+    }
+};
+
+// Очередь на std::mutex + две условные переменные
+template <typename T>
+class MutexQueue {
+private:
+    std::mutex mtx;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+    std::deque<T> items;
+    const size_t capacity;
+
+public:
+    explicit MutexQueue(size_t capacity) : capacity(capacity) {}
+
+    void push(const T& value) {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            notFull.wait(lock, [this]() { return items.size() < capacity; });
+            items.push_back(value);
+        }
+        notEmpty.notify_one();
+    }
+
+    T pop() {
+        T value;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            notEmpty.wait(lock, [this]() { return !items.empty(); });
+            value = items.front();
+            items.pop_front();
+        }
+        notFull.notify_one();
+        return value;
+    }
+};
+
+// Классический ограниченный буфер: семафоры свободных и занятых ячеек
+// (FastSemaphore - тот же, что Semaphore в test.cpp) и мьютекс на кольцо
+template <typename T>
+class SemaphoreQueue {
+private:
+    std::vector<T> ring;
+    size_t head = 0;
+    size_t tail = 0;
+    std::mutex ringMutex;
+    FastSemaphore freeSlots;
+    FastSemaphore filledSlots;
+
+public:
+    explicit SemaphoreQueue(size_t capacity)
+        : ring(capacity), freeSlots(static_cast<int>(capacity)), filledSlots(0) {}
+
+    void push(const T& value) {
+        freeSlots.acquire();
+        {
+            std::lock_guard<std::mutex> lock(ringMutex);
+            ring[tail] = value;
+            tail = (tail + 1) % ring.size();
+        }
+        filledSlots.release();
+    }
+
+    T pop() {
+        filledSlots.acquire();
+        T value;
+        {
+            std::lock_guard<std::mutex> lock(ringMutex);
+            value = ring[head];
+            head = (head + 1) % ring.size();
+        }
+        freeSlots.release();
+        return value;
+    }
+};
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// Распределители блоков одного размера для узлов контейнеров под блокировкой.
+// Общий интерфейс: каждый рабочий поток заводит Allocator::Local local(allocator)
+// и берёт/отдаёт блоки через local.allocate() / local.deallocate(p). Блок может
+// освободить не тот поток, который его выделил. Local нужен пулу с кэшем потока:
+// у остальных это просто ссылка на общий распределитель.
+
+// glibc malloc: ::operator new / ::operator delete
+class MallocNodeAllocator {
+private:
+    size_t blockBytes;
+public:
+    explicit MallocNodeAllocator(size_t bytes) : blockBytes(bytes) {}
+
+    class Local {
+    private:
+        MallocNodeAllocator& owner;
+    public:
+        explicit Local(MallocNodeAllocator& allocator) : owner(allocator) {}
+        void* allocate() { return ::operator new(owner.blockBytes); }
+        void deallocate(void* p) { ::operator delete(p, owner.blockBytes); }
+    };
+};
+
+// std::pmr::synchronized_pool_resource: пулы по размерам, в libstdc++ - свои
+// на каждый поток с общим shared_mutex на пути к чужим пулам
+class PmrPoolNodeAllocator {
+private:
+    size_t blockBytes;
+    std::pmr::synchronized_pool_resource pool;
+public:
+    explicit PmrPoolNodeAllocator(size_t bytes)
+        : blockBytes(bytes), pool(std::pmr::pool_options{0, bytes}) {}
+
+    class Local {
+    private:
+        PmrPoolNodeAllocator& owner;
+    public:
+        explicit Local(PmrPoolNodeAllocator& allocator) : owner(allocator) {}
+        void* allocate() { return owner.pool.allocate(owner.blockBytes, alignof(std::max_align_t)); }
+        void deallocate(void* p) { owner.pool.deallocate(p, owner.blockBytes, alignof(std::max_align_t)); }
+    };
+};
+
+// Общий запас блоков: нарезка больших кусков и список свободных под мьютексом.
+// Память кусков возвращается только в деструкторе.
+class SlabStore {
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    size_t blockBytes;
+    size_t blocksPerSlab;
+    std::vector<void*> slabs;
+    FreeBlock* free = nullptr;
+    std::mutex mtx;
+
+    static size_t roundUp(size_t bytes) {
+        size_t align = alignof(std::max_align_t);
+        bytes = bytes < sizeof(FreeBlock) ? sizeof(FreeBlock) : bytes;
+        return (bytes + align - 1) / align * align;
+    }
+
+public:
+    explicit SlabStore(size_t bytes, size_t slabBytes = 64 * 1024)
+        : blockBytes(roundUp(bytes)), blocksPerSlab(slabBytes / roundUp(bytes)) {}
+    SlabStore(const SlabStore&) = delete;
+    SlabStore& operator=(const SlabStore&) = delete;
+
+    ~SlabStore() {
+        for (void* slab : slabs) {
+            ::operator delete(slab);
+        }
+    }
+
+    size_t bytesPerBlock() const { return blockBytes; }
+
+    // До count блоков в out; новые куски нарезаются по мере надобности
+    void take(std::vector<void*>& out, size_t count) {
+        std::lock_guard<std::mutex> lock(mtx);
+        while (count > 0) {
+            if (free == nullptr) {
+                char* slab = static_cast<char*>(::operator new(blockBytes * blocksPerSlab));
+                slabs.push_back(slab);
+                for (size_t k = 0; k < blocksPerSlab; ++k) {
+                    auto* block = reinterpret_cast<FreeBlock*>(slab + k * blockBytes);
+                    block->next = free;
+                    free = block;
+                }
+            }
+            out.push_back(free);
+            free = free->next;
+            --count;
+        }
+    }
+
+    void give(void* const* blocks, size_t count) {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (size_t k = 0; k < count; ++k) {
+            auto* block = static_cast<FreeBlock*>(blocks[k]);
+            block->next = free;
+            free = block;
+        }
+    }
+
+    size_t slabCount() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return slabs.size();
+    }
+};
+
+// Пул с кэшем потока: выделение и освобождение идут в свой кэш без синхронизации,
+// с общим запасом обмениваемся пачками по batch блоков. Освобождённый чужим потоком
+// блок остаётся в кэше освободившего - блоки одного размера, им всё равно.
+class ThreadCachePoolAllocator {
+private:
+    SlabStore store;
+    size_t batch;
+public:
+    explicit ThreadCachePoolAllocator(size_t bytes, size_t batchBlocks = 64)
+        : store(bytes), batch(batchBlocks) {}
+
+    class Local {
+    private:
+        ThreadCachePoolAllocator& owner;
+        std::vector<void*> cache;
+    public:
+        explicit Local(ThreadCachePoolAllocator& allocator) : owner(allocator) {
+            cache.reserve(2 * owner.batch);
+        }
+        Local(const Local&) = delete;
+        Local& operator=(const Local&) = delete;
+
+        ~Local() {
+            owner.store.give(cache.data(), cache.size());
+        }
+
+        void* allocate() {
+            if (cache.empty()) {
+                owner.store.take(cache, owner.batch);
+            }
+            void* p = cache.back();
+            cache.pop_back();
+            return p;
+        }
+
+        // Кэш не растёт больше 2 * batch: лишняя пачка уходит в общий запас
+        void deallocate(void* p) {
+            if (cache.size() >= 2 * owner.batch) {
+                owner.store.give(cache.data() + owner.batch, cache.size() - owner.batch);
+                cache.resize(owner.batch);
+            }
+            cache.push_back(p);
+        }
+    };
+
+    size_t slabCount() { return store.slabCount(); }
+};
+
+// Lock-free список свободных блоков: стек Трайбера с тегом версии в старших
+// 16 битах вершины (как в TreiberStack.h). Освобождать узлы через EBR не нужно:
+// блоки не возвращаются системе до деструктора, так что чтение next у блока,
+// который уже снял другой поток, безопасно - устаревшее значение отсеет CAS по тегу.
+class LockFreeFreelistAllocator {
+    static_assert(sizeof(void*) == 8, "tagged pointers need a 64-bit address space");
+
+private:
+    struct Block {
+        std::atomic<Block*> next;
+    };
+
+    static constexpr std::uint64_t kPointerMask = (std::uint64_t{1} << 48) - 1;
+
+    static Block* pointer(std::uint64_t word) {
+        return reinterpret_cast<Block*>(word & kPointerMask);
+    }
+
+    static std::uint64_t pack(Block* block, std::uint64_t previous) {
+        std::uint64_t tag = (previous >> 48) + 1;
+        return (tag << 48) | (reinterpret_cast<std::uint64_t>(block) & kPointerMask);
+    }
+
+    SlabStore store;
+    size_t refill;
+    alignas(64) std::atomic<std::uint64_t> head{0};
+
+    void push(Block* block) {
+        std::uint64_t old = head.load(std::memory_order_relaxed);
+        do {
+            block->next.store(pointer(old), std::memory_order_relaxed);
+        } while (!head.compare_exchange_weak(old, pack(block, old),
+                 std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    Block* pop() {
+        std::uint64_t old = head.load(std::memory_order_acquire);
+        while (Block* block = pointer(old)) {
+            if (head.compare_exchange_weak(old, pack(block->next.load(std::memory_order_relaxed), old),
+                    std::memory_order_acquire, std::memory_order_acquire)) {
+                return block;
+            }
+        }
+        return nullptr;
+    }
+
+public:
+    explicit LockFreeFreelistAllocator(size_t bytes, size_t refillBlocks = 256)
+        : store(bytes < sizeof(Block) ? sizeof(Block) : bytes), refill(refillBlocks) {}
+
+    void* allocate() {
+        if (Block* block = pop()) {
+            return block;
+        }
+        // Список пуст: новая пачка из запаса, один блок себе, остальные в список
+        std::vector<void*> fresh;
+        fresh.reserve(refill);
+        store.take(fresh, refill);
+        for (size_t k = 1; k < fresh.size(); ++k) {
+            push(static_cast<Block*>(fresh[k]));
+        }
+        return fresh[0];
+    }
+
+    void deallocate(void* p) {
+        push(static_cast<Block*>(p));
+    }
+
+    class Local {
+    private:
+        LockFreeFreelistAllocator& owner;
+    public:
+        explicit Local(LockFreeFreelistAllocator& allocator) : owner(allocator) {}
+        void* allocate() { return owner.allocate(); }
+        void deallocate(void* p) { owner.deallocate(p); }
+    };
+
+    size_t slabCount() { return store.slabCount(); }
+};
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Locks.h"
+#include "SpinWait.h"
+
+// Разделяемый сегмент памяти: shm_open + mmap(MAP_SHARED). Имя удаляется сразу
+// после отображения - сегмент живёт, пока его держат отображения (наши и
+// унаследованные через fork).
+class SharedSegment {
+private:
+    void* address = nullptr;
+    size_t length;
+public:
+    explicit SharedSegment(size_t bytes) : length(bytes) {
+        std::string name = "/lr34_race_" + std::to_string(getpid());
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "shm_open");
+        }
+        shm_unlink(name.c_str());
+        if (ftruncate(fd, static_cast<off_t>(length)) != 0) {
+            int err = errno;
+            close(fd);
+            throw std::system_error(err, std::generic_category(), "ftruncate");
+        }
+        address = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        int err = errno;
+        close(fd);
+        if (address == MAP_FAILED) {
+            throw std::system_error(err, std::generic_category(), "mmap");
+        }
+    }
+
+    ~SharedSegment() {
+        munmap(address, length);
+    }
+
+    SharedSegment(const SharedSegment&) = delete;
+    SharedSegment& operator=(const SharedSegment&) = delete;
+
+    void* data() const {
+        return address;
+    }
+};
+
+// pthread-мьютекс с PTHREAD_PROCESS_SHARED, по желанию робастный.
+// Робастный мьютекс, чей владелец умер, отдаётся следующему с EOWNERDEAD -
+// тот помечает состояние согласованным и продолжает.
+class SharedPthreadMutex {
+private:
+    pthread_mutex_t mtx;
+    std::atomic<long> recoveries{0};
+public:
+    explicit SharedPthreadMutex(bool robust = false) {
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        if (robust) {
+            pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        }
+        int rc = pthread_mutex_init(&mtx, &attr);
+        pthread_mutexattr_destroy(&attr);
+        if (rc != 0) {
+            throw std::system_error(rc, std::generic_category(), "pthread_mutex_init");
+        }
+    }
+
+    ~SharedPthreadMutex() {
+        pthread_mutex_destroy(&mtx);
+    }
+
+    SharedPthreadMutex(const SharedPthreadMutex&) = delete;
+    SharedPthreadMutex& operator=(const SharedPthreadMutex&) = delete;
+
+    void lock() {
+        if (pthread_mutex_lock(&mtx) == EOWNERDEAD) {
+            // Владелец умер в секции: данные под защитой надо проверить (здесь - нечего)
+            pthread_mutex_consistent(&mtx);
+            recoveries.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    bool try_lock() {
+        int rc = pthread_mutex_trylock(&mtx);
+        if (rc == EOWNERDEAD) {
+            pthread_mutex_consistent(&mtx);
+            recoveries.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return rc == 0;
+    }
+
+    void unlock() {
+        pthread_mutex_unlock(&mtx);
+    }
+
+    long ownerDeaths() const {
+        return recoveries.load(std::memory_order_relaxed);
+    }
+};
+
+// Futex-блокировка 0/1/2 (как SpinWaitLock), но с разделяемыми futex-операциями:
+// atomic::wait в libstdc++ использует FUTEX_*_PRIVATE и между процессами не будит
+class SharedFutexLock {
+private:
+    std::atomic<int> state{0};
+
+    long futex(int op, int value) {
+        return syscall(SYS_futex, reinterpret_cast<int*>(&state), op, value, nullptr, nullptr, 0);
+    }
+public:
+    void lock() {
+        int expected = 0;
+        if (state.compare_exchange_strong(expected, 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            return;
+        }
+        SpinWait spin(SpinPolicy::escalating().withoutPark());
+        for (int n = 0; n < 20; ++n) {
+            expected = 0;
+            if (state.compare_exchange_weak(expected, 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return;
+            }
+            spin.spinOnce();
+        }
+        while (state.exchange(2, std::memory_order_acquire) != 0) {
+            futex(FUTEX_WAIT, 2);
+        }
+    }
+
+    bool try_lock() {
+        int expected = 0;
+        return state.compare_exchange_strong(expected, 1, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock() {
+        if (state.exchange(0, std::memory_order_release) == 2) {
+            futex(FUTEX_WAKE, 1);
+        }
+    }
+};
+
+// Гонка процессов: N дочерних процессов (fork) захватывают блокировку в общем
+// сегменте и увеличивают общий счётчик. Тот же объект в том же сегменте затем
+// гоняют N потоков одного процесса - разница и есть цена межпроцессности.
+class ProcessSharedTest {
+private:
+    int numWorkers;
+    int iterations;
+
+    template <typename Lock>
+    struct Arena {
+        std::atomic<int> start{0};
+        alignas(64) Lock lock;
+        alignas(64) long counter = 0;
+        char results[256] = {};
+
+        template <typename... Args>
+        explicit Arena(Args&&... args) : lock(std::forward<Args>(args)...) {}
+    };
+
+    template <typename Lock>
+    static void work(Arena<Lock>* arena, int id, int iterations) {
+        // Без парковки: futex из atomic::wait приватный и другой процесс его не разбудит
+        SpinWait spin(SpinPolicy::handoff());
+        spin.waitWhileEquals(arena->start, 0);
+        for (int j = 0; j < iterations; ++j) {
+            arena->lock.lock();
+            ++arena->counter;
+            arena->results[id % 256] = static_cast<char>(33 + (j + id) % 94);
+            arena->lock.unlock();
+        }
+    }
+
+    // Возвращает наносекунд на захват; counterOk - итог счётчика сошёлся
+    template <typename Lock>
+    double runProcesses(Arena<Lock>* arena, bool& counterOk) {
+        arena->counter = 0;
+        arena->start.store(0, std::memory_order_release);
+        std::vector<pid_t> children;
+        for (int p = 0; p < numWorkers; ++p) {
+            pid_t pid = fork();
+            if (pid < 0) {
+                throw std::system_error(errno, std::generic_category(), "fork");
+            }
+            if (pid == 0) {
+                work(arena, p, iterations);
+                _exit(0); // без atexit-обработчиков родителя (Tracer и т.п.)
+            }
+            children.push_back(pid);
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        arena->start.store(1, std::memory_order_release);
+        for (pid_t pid : children) {
+            waitpid(pid, nullptr, 0);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        counterOk = arena->counter == 1L * numWorkers * iterations;
+        return std::chrono::duration<double, std::nano>(end - start).count() / (1.0 * numWorkers * iterations);
+    }
+
+    template <typename Lock>
+    double runThreads(Arena<Lock>* arena, bool& counterOk) {
+        arena->counter = 0;
+        arena->start.store(0, std::memory_order_release);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < numWorkers; ++t) {
+            threads.emplace_back([arena, t, this]() { work(arena, t, iterations); });
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        arena->start.store(1, std::memory_order_release);
+        for (auto& th : threads) {
+            th.join();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        counterOk = arena->counter == 1L * numWorkers * iterations;
+        return std::chrono::duration<double, std::nano>(end - start).count() / (1.0 * numWorkers * iterations);
+    }
+
+    template <typename Lock, typename... Args>
+    void run(const std::string& name, Args&&... args) {
+        SharedSegment segment(sizeof(Arena<Lock>));
+        auto* arena = new (segment.data()) Arena<Lock>(std::forward<Args>(args)...);
+
+        bool processesOk = false;
+        bool threadsOk = false;
+        double crossProcess = runProcesses(arena, processesOk);
+        double inProcess = runThreads(arena, threadsOk);
+
+        std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+                  << " processes " << std::setw(8) << crossProcess << " ns/acq"
+                  << ", threads " << std::setw(8) << inProcess << " ns/acq"
+                  << ", cross/in " << std::setprecision(2) << crossProcess / inProcess << "x"
+                  << std::defaultfloat
+                  << (processesOk && threadsOk ? "" : ", COUNTER MISMATCH") << "\n";
+        arena->~Arena<Lock>();
+    }
+
+    // Дочерний процесс берёт робастный мьютекс и умирает, не отпустив его
+    void testOwnerDeath() {
+        SharedSegment segment(sizeof(SharedPthreadMutex));
+        auto* mtx = new (segment.data()) SharedPthreadMutex(true);
+        pid_t pid = fork();
+        if (pid < 0) {
+            throw std::system_error(errno, std::generic_category(), "fork");
+        }
+        if (pid == 0) {
+            mtx->lock();
+            _exit(0);
+        }
+        waitpid(pid, nullptr, 0);
+
+        auto t0 = std::chrono::high_resolution_clock::now();
+        mtx->lock();
+        auto t1 = std::chrono::high_resolution_clock::now();
+        mtx->unlock();
+        std::cout << "Robust mutex owner death: " << (mtx->ownerDeaths() == 1 ? "recovered" : "NOT recovered")
+                  << " via EOWNERDEAD in "
+                  << std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() << " ns\n";
+        mtx->~SharedPthreadMutex();
+    }
+
+public:
+    ProcessSharedTest(int workers, int iters = 100000) : numWorkers(workers), iterations(iters) {}
+
+    void runAllTests() {
+        std::cout << "=== Process-Shared Lock Tests ===\n";
+        std::cout << "Workers: " << numWorkers << ", Iterations per worker: " << iterations << "\n\n";
+
+        run<SharedPthreadMutex>("pshared pthread mutex", false);
+        run<SharedPthreadMutex>("robust pshared mutex", true);
+        run<SharedFutexLock>("shared futex lock");
+        run<TasSpinLock>("atomic TAS spin");
+        std::cout << "\n";
+        testOwnerDeath();
+    }
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include "MpmcQueue.h"
+#include "Tracer.h"
+
+// Режим "производители/потребители": производители кладут элементы с меткой
+// времени в ограниченную очередь, потребители забирают их и считают задержку
+// от постановки до извлечения.
+class ProducerConsumerTest {
+private:
+    struct Item {
+        long long enqueuedNs = 0;
+        int producer = -1; // -1 - сигнал потребителю завершиться
+    };
+
+    int numProducers;
+    int numConsumers;
+    int itemsPerProducer;
+    size_t capacity;
+
+    static long long nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static long long percentile(const std::vector<long long>& sorted, double p) {
+        if (sorted.empty()) {
+            return 0;
+        }
+        return sorted[static_cast<size_t>(p * (sorted.size() - 1))];
+    }
+
+public:
+    ProducerConsumerTest(int producers, int consumers, int items = 100000, size_t queueCapacity = 1024)
+        : numProducers(producers), numConsumers(consumers),
+          itemsPerProducer(items), capacity(queueCapacity) {}
+
+    template <typename Queue>
+    void run(const std::string& name) {
+        Queue queue(capacity);
+        std::vector<std::thread> producers;
+        std::vector<std::thread> consumers;
+        std::vector<std::vector<long long>> latencies(numConsumers);
+
+        auto start = std::chrono::high_resolution_clock::now();
+
+        for (int c = 0; c < numConsumers; ++c) {
+            consumers.emplace_back([&queue, &latencies, c, &name, this]() {
+                RACE_TRACE_PHASE_BEGIN("consume " + name);
+                latencies[c].reserve(static_cast<size_t>(itemsPerProducer) * numProducers / numConsumers + 1);
+                for (;;) {
+                    Item item = queue.pop();
+                    if (item.producer < 0) {
+                        break;
+                    }
+                    latencies[c].push_back(nowNs() - item.enqueuedNs);
+                }
+                RACE_TRACE_PHASE_END("consume " + name);
+            });
+        }
+
+        for (int p = 0; p < numProducers; ++p) {
+            producers.emplace_back([&queue, p, &name, this]() {
+                RACE_TRACE_PHASE_BEGIN("produce " + name);
+                for (int j = 0; j < itemsPerProducer; ++j) {
+                    queue.push(Item{nowNs(), p});
+                }
+                RACE_TRACE_PHASE_END("produce " + name);
+            });
+        }
+
+        for (auto& t : producers) {
+            t.join();
+        }
+        for (int c = 0; c < numConsumers; ++c) {
+            queue.push(Item{});
+        }
+        for (auto& t : consumers) {
+            t.join();
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+
+        std::vector<long long> all;
+        for (auto& l : latencies) {
+            all.insert(all.end(), l.begin(), l.end());
+        }
+        std::sort(all.begin(), all.end());
+
+        std::cout << name << " - " << static_cast<long long>(all.size() / seconds) << " items/sec"
+                  << ", latency p50 " << percentile(all, 0.50)
+                  << " ns, p99 " << percentile(all, 0.99)
+                  << " ns, max " << (all.empty() ? 0 : all.back()) << " ns\n";
+    }
+
+    void runAllTests() {
+        std::cout << "=== Producer/Consumer Tests ===\n";
+        std::cout << "Producers: " << numProducers << ", Consumers: " << numConsumers
+                  << ", Items per producer: " << itemsPerProducer
+                  << ", Capacity: " << capacity << "\n\n";
+
+        run<VyukovQueue<Item>>("Vyukov MPMC queue   ");
+        run<MutexQueue<Item>>("Mutex+condvar queue ");
+        run<SemaphoreQueue<Item>>("Semaphore queue     ");
+    }
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <pthread.h>
+#include <cerrno>
+#include <system_error>
+
+// Нативные блокировки glibc с явно выбранным типом - std::mutex всегда даёт
+// PTHREAD_MUTEX_NORMAL (по умолчанию), а другие типы через него не получить.
+// Интерфейс тот же lock()/unlock()/try_lock(), что и у адаптеров из Locks.h.
+
+namespace pthread_detail {
+    inline void check(int rc, const char* what) {
+        if (rc != 0) {
+            throw std::system_error(rc, std::generic_category(), what);
+        }
+    }
+}
+
+// pthread_mutex_t заданного типа и протокола
+template <int Type, int Protocol = PTHREAD_PRIO_NONE>
+class PthreadMutexLock {
+private:
+    pthread_mutex_t mtx;
+public:
+    PthreadMutexLock() {
+        pthread_mutexattr_t attr;
+        pthread_detail::check(pthread_mutexattr_init(&attr), "pthread_mutexattr_init");
+        pthread_detail::check(pthread_mutexattr_settype(&attr, Type), "pthread_mutexattr_settype");
+        pthread_detail::check(pthread_mutexattr_setprotocol(&attr, Protocol), "pthread_mutexattr_setprotocol");
+        int rc = pthread_mutex_init(&mtx, &attr);
+        pthread_mutexattr_destroy(&attr);
+        pthread_detail::check(rc, "pthread_mutex_init");
+    }
+
+    ~PthreadMutexLock() {
+        pthread_mutex_destroy(&mtx);
+    }
+
+    PthreadMutexLock(const PthreadMutexLock&) = delete;
+    PthreadMutexLock& operator=(const PthreadMutexLock&) = delete;
+
+    void lock() { pthread_mutex_lock(&mtx); }
+    bool try_lock() { return pthread_mutex_trylock(&mtx) == 0; }
+    void unlock() { pthread_mutex_unlock(&mtx); }
+};
+
+// Адаптивный мьютекс: перед сном на futex немного крутится (до __spins раз)
+using AdaptivePthreadMutex = PthreadMutexLock<PTHREAD_MUTEX_ADAPTIVE_NP>;
+
+// Мьютекс с наследованием приоритета: захват под конкуренцией всегда идёт
+// через ядро (FUTEX_LOCK_PI), поэтому дороже обычного
+using PiPthreadMutex = PthreadMutexLock<PTHREAD_MUTEX_NORMAL, PTHREAD_PRIO_INHERIT>;
+
+// pthread_spinlock_t: чистый спин без засыпания
+class PthreadSpinLock {
+private:
+    pthread_spinlock_t spin;
+public:
+    PthreadSpinLock() {
+        pthread_detail::check(pthread_spin_init(&spin, PTHREAD_PROCESS_PRIVATE), "pthread_spin_init");
+    }
+
+    ~PthreadSpinLock() {
+        pthread_spin_destroy(&spin);
+    }
+
+    PthreadSpinLock(const PthreadSpinLock&) = delete;
+    PthreadSpinLock& operator=(const PthreadSpinLock&) = delete;
+
+    void lock() { pthread_spin_lock(&spin); }
+    bool try_lock() { return pthread_spin_trylock(&spin) == 0; }
+    void unlock() { pthread_spin_unlock(&spin); }
+};
+
+// pthread_rwlock_t с предпочтением писателей (без него glibc отдаёт
+// предпочтение читателям, и писатель может голодать).
+// lock()/unlock() - захват писателем, lock_shared()/unlock_shared() - читателем.
+class PthreadWriterRwLock {
+private:
+    pthread_rwlock_t rw;
+public:
+    PthreadWriterRwLock() {
+        pthread_rwlockattr_t attr;
+        pthread_detail::check(pthread_rwlockattr_init(&attr), "pthread_rwlockattr_init");
+        pthread_detail::check(pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP),
+                              "pthread_rwlockattr_setkind_np");
+        int rc = pthread_rwlock_init(&rw, &attr);
+        pthread_rwlockattr_destroy(&attr);
+        pthread_detail::check(rc, "pthread_rwlock_init");
+    }
+
+    ~PthreadWriterRwLock() {
+        pthread_rwlock_destroy(&rw);
+    }
+
+    PthreadWriterRwLock(const PthreadWriterRwLock&) = delete;
+    PthreadWriterRwLock& operator=(const PthreadWriterRwLock&) = delete;
+
+    void lock() { pthread_rwlock_wrlock(&rw); }
+    bool try_lock() { return pthread_rwlock_trywrlock(&rw) == 0; }
+    void unlock() { pthread_rwlock_unlock(&rw); }
+
+    void lock_shared() { pthread_rwlock_rdlock(&rw); }
+    bool try_lock_shared() { return pthread_rwlock_tryrdlock(&rw) == 0; }
+    void unlock_shared() { pthread_rwlock_unlock(&rw); }
+};
+
+// Вызывает f.template operator()<Lock>(name) для каждого нативного варианта
+template <typename F>
+void forEachPthreadLock(F&& f) {
+    f.template operator()<PthreadMutexLock<PTHREAD_MUTEX_NORMAL>>("pthread normal");
+    f.template operator()<AdaptivePthreadMutex>("pthread adaptive");
+    f.template operator()<PiPthreadMutex>("pthread PI");
+    f.template operator()<PthreadSpinLock>("pthread spinlock");
+    f.template operator()<PthreadWriterRwLock>("pthread rwlock (writer)");
+}
@@ -12,15 +12,105 @@
 #include <semaphore>
 #include <barrier>
 #include <functional>
+#include <deque>
+#include <memory>
+#include <iomanip>
+#include <algorithm>
+#include <optional>
+#include <type_traits>
 #include "benchmark.h"
+#include "FastSemaphore.h"
+#include "Locks.h"
+#include "LockProfiler.h"
+#include "CpuUsage.h"
+#include "SpinPrimitives.h"
+#include "SeqLock.h"
+#include "Tracer.h"
+#include "BiasedLock.h"
+#include "McsLock.h"
+#include "AdaptiveLock.h"
+#include "PthreadLocks.h"
+#include "SpinWait.h"
+#include "WorkloadSpec.h"
 
 class ThreadRaceTest {
 private:
     std::vector<std::thread> threads;
     std::vector<char> results;
     std::vector<long long> threadTimes;
+    std::vector<CpuUsage> threadCpu;
+    RunEfficiency lastRun;
     int numThreads;
     int raceLength;
+    int holdMicros = 10; // длительность "работы" внутри критической секции
+    int holdWorkNs = 0;  // активная работа в секции (без сна), наносекунды
+    int observerHz = 0;  // 0 - наблюдатель выключен
+    int skewPercent = 0; // >0 - поток 0 делает такую долю всех захватов
+    int batchSize = 0;   // обновлений за один захват; 0 - пакетный режим выключен
+    
+    // Устаревание при пакетной записи: от генерации символа до публикации в results
+    struct Staleness {
+        long long sumNs = 0;
+        long long maxNs = 0;
+        long long count = 0;
+        
+        double avgNs() const { return count ? static_cast<double>(sumNs) / count : 0.0; }
+    };
+    std::vector<Staleness> threadStaleness;
+    Staleness lastStaleness;
+    
+    // Открытый цикл: запросы приходят по расписанию с суммарной частотой arrivalRate,
+    // задержка считается от запланированного момента, а не от фактического начала
+    // попытки - иначе отставший поток "забывает" про очередь (coordinated omission)
+    double arrivalRate = 0;      // запросов в секунду на все потоки; 0 - замкнутый цикл
+    bool poissonArrivals = true; // false - равные интервалы
+    std::vector<std::vector<long long>> threadLatency;
+    // Частоты потока: сгенерированная расписанием и фактически обслуженная
+    // (по собственному интервалу потока, без разброса старта потоков)
+    struct ThreadRates {
+        double generated = 0;
+        double achieved = 0;
+    };
+    std::vector<ThreadRates> threadRates;
+    
+    // Профиль нагрузки (WorkloadSpec.h): заменяет holdMicros/holdWorkNs распределениями
+    // удержания и паузы между захватами, часть захватов уходит на блокировку потока
+    std::optional<WorkloadSpec> workload;
+    struct WorkloadCounters {
+        long long shared = 0;
+        long long privateAcquisitions = 0;
+        long long holdNs = 0;          // измеренное время
+        long long thinkNs = 0;
+        long long holdRequestedNs = 0; // выборки из распределений
+        long long thinkRequestedNs = 0;
+    };
+    std::vector<WorkloadCounters> threadWorkload;
+    
+public:
+    struct OpenLoopStats {
+        double offered = 0;   // заданная частота
+        double generated = 0; // фактически сгенерированная расписанием
+        double achieved = 0;  // обслуженная
+        long long p50 = 0;
+        long long p99 = 0;
+        long long p999 = 0;
+        long long max = 0;
+    };
+    
+private:
+    OpenLoopStats lastOpenLoop;
+    
+    // Состояние гонщика для наблюдателя: у каждого потока свой seqlock на своей
+    // кэш-линии, так что писатели не мешают друг другу, а наблюдатель не берёт
+    // блокировку гонки
+    struct RaceSlot {
+        int progress;
+        char symbol;
+    };
+    struct alignas(64) ObservedSlot {
+        SeqLock<RaceSlot> state;
+    };
+    std::unique_ptr<ObservedSlot[]> observed;
     
     // Случайная генерация символов
     char generateRandomChar() {
@@ -36,29 +126,277 @@ public:
         threadTimes.resize(numThreads, 0);
     }
     
-    // Тест с использованием мьютекса
-    void testWithMutex() {
-        std::mutex mtx;
+    // 0 - пустая критическая секция (видна цена самого примитива)
+    void setHoldTime(int micros) {
+        holdMicros = micros;
+    }
+    
+    // Активная работа в секции: крутимся по часам ns наносекунд, не отдавая процессор.
+    // Для коротких секций, которые sleep_for не умеет (он спит не меньше десятков мкс).
+    void setHoldWork(int ns) {
+        holdWorkNs = ns;
+    }
+    
+    // Перекос нагрузки: поток 0 делает percent% от numThreads * raceLength захватов,
+    // остальные делят остаток поровну; 0 - у всех по raceLength
+    void setSkew(int percent) {
+        skewPercent = percent;
+    }
+    
+    // Пакетный режим: поток копит k обновлений локально и публикует их за один захват.
+    // raceLength остаётся числом обновлений на поток, захватов становится в k раз меньше.
+    // При k = 1 символ тоже готовится вне блокировки, так что устаревание
+    // включает ожидание блокировки; 0 выключает режим.
+    void setBatchSize(int k) {
+        batchSize = std::max(0, k);
+    }
+    
+    // Открытый цикл с суммарной частотой perSecond (0 - вернуться к замкнутому).
+    // Каждый поток получает свой поток заявок с частотой perSecond / numThreads:
+    // сумма независимых пуассоновских потоков снова пуассоновская.
+    void setArrivalRate(double perSecond, bool poisson = true) {
+        arrivalRate = std::max(0.0, perSecond);
+        poissonArrivals = poisson;
+    }
+    
+    // Профиль нагрузки вместо фиксированного удержания; clearWorkload() - вернуть как было
+    void setWorkload(const WorkloadSpec& spec) {
+        workload = spec;
+    }
+    
+    void clearWorkload() {
+        workload.reset();
+    }
+    
+    // Живой наблюдатель: hz раз в секунду печатает прогресс и текущие results
+    void enableObserver(int hz = 30) {
+        observerHz = hz;
+    }
+    
+    // CPU-учёт последнего прогона
+    const RunEfficiency& lastEfficiency() const {
+        return lastRun;
+    }
+    
+    // Задержки последнего прогона в открытом цикле
+    const OpenLoopStats& lastOpenLoopStats() const {
+        return lastOpenLoop;
+    }
+    
+private:
+    // Число захватов потока i с учётом перекоса
+    int iterationsFor(int i) const {
+        if (skewPercent <= 0 || numThreads < 2) {
+            return raceLength;
+        }
+        long long total = 1LL * numThreads * raceLength;
+        long long hot = total * skewPercent / 100;
+        if (i == 0) {
+            return static_cast<int>(hot);
+        }
+        long long rest = total - hot;
+        int others = numThreads - 1;
+        return static_cast<int>(rest / others + (i - 1 < rest % others ? 1 : 0));
+    }
+    
+    static long long percentile(const std::vector<long long>& sorted, double p) {
+        if (sorted.empty()) {
+            return 0;
+        }
+        return sorted[static_cast<size_t>(p * (sorted.size() - 1))];
+    }
+    
+    // Поток наблюдателя: читает снимки из seqlock'ов, пока не выставлен done
+    std::thread startObserver(const std::atomic<bool>& done, CpuUsage& observerCpu) {
+        return std::thread([this, &done, &observerCpu]() {
+            CpuUsage cpuStart = CpuUsage::thisThread();
+            auto period = std::chrono::microseconds(1000000 / observerHz);
+            auto start = std::chrono::steady_clock::now();
+            long long snapshots = 0;
+            long long snapshotNs = 0;
+            long long retries = 0;
+            std::vector<RaceSlot> snapshot(numThreads);
+            
+            while (!done.load(std::memory_order_acquire)) {
+                std::this_thread::sleep_for(period);
+                
+                auto t0 = std::chrono::steady_clock::now();
+                for (int i = 0; i < numThreads; ++i) {
+                    snapshot[i] = observed[i].state.read(&retries);
+                }
+                auto t1 = std::chrono::steady_clock::now();
+                snapshotNs += std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+                ++snapshots;
+                
+                std::string symbols;
+                long long finished = 0;
+                for (const auto& slot : snapshot) {
+                    symbols += slot.symbol;
+                    finished += slot.progress;
+                }
+                std::cout << "  [observer +" 
+                          << std::chrono::duration_cast<std::chrono::milliseconds>(t1 - start).count()
+                          << " ms] " << 100 * finished / (1LL * numThreads * raceLength) << "% |";
+                for (int i = 0; i < numThreads; ++i) {
+                    std::cout << " " << 100 * snapshot[i].progress / std::max(1, iterationsFor(i));
+                }
+                std::cout << " | results \"" << symbols << "\"\n";
+            }
+            
+            observerCpu = CpuUsage::thisThread() - cpuStart;
+            std::cout << "    Observer: " << snapshots << " snapshots at " << observerHz << " Hz"
+                      << ", avg snapshot " << (snapshots ? snapshotNs / snapshots : 0) << " ns"
+                      << ", seqlock retries " << retries << "\n";
+        });
+    }
+    
+    // Общий цикл гонки: поток i raceLength раз захватывает lockFor(i) и пишет свой символ.
+    // С профилем нагрузки часть захватов идёт на privateFor(i) - блокировку самого потока.
+    template <typename LockFor>
+    void raceLoop(const std::string& name, LockFor lockFor) {
+        raceLoop(name, lockFor, lockFor);
+    }
+
+    template <typename LockFor, typename PrivateFor>
+    void raceLoop(const std::string& name, LockFor lockFor, PrivateFor privateFor) {
         results.assign(numThreads, ' ');
+        threadWorkload.assign(numThreads, WorkloadCounters{});
         threadTimes.assign(numThreads, 0);
+        threadCpu.assign(numThreads, CpuUsage{});
+        threadStaleness.assign(numThreads, Staleness{});
+        threadLatency.assign(numThreads, {});
+        threadRates.assign(numThreads, ThreadRates{});
         threads.clear();
         
+        std::atomic<bool> raceDone{false};
+        CpuUsage observerCpu;
+        std::thread observer;
+        ObservedSlot* slots = nullptr;
+        if (observerHz > 0) {
+            observed.reset(new ObservedSlot[numThreads]);
+            slots = observed.get();
+            for (int i = 0; i < numThreads; ++i) {
+                slots[i].state.write({0, ' '});
+            }
+            observer = startObserver(raceDone, observerCpu);
+        }
+        
         auto start = std::chrono::high_resolution_clock::now();
         
         for (int i = 0; i < numThreads; ++i) {
-            threads.emplace_back([this, i, &mtx]() {
+            threads.emplace_back([this, i, &lockFor, &privateFor, slots, &name]() {
+                auto& sharedLock = lockFor(i);
+                auto& ownLock = privateFor(i);
+                std::mt19937_64 workloadRng;
+                if (workload) {
+                    workloadRng.seed(std::random_device{}());
+                }
+                WorkloadCounters& wc = threadWorkload[i];
                 auto threadStart = std::chrono::high_resolution_clock::now();
+                CpuUsage cpuStart = CpuUsage::thisThread();
+                RACE_TRACE_PHASE_BEGIN("race " + name);
                 
-                for (int j = 0; j < raceLength; ++j) {
-                    std::lock_guard<std::mutex> lock(mtx);
-                    results[i] = generateRandomChar();
+                int iterations = iterationsFor(i);
+                struct Pending {
+                    char symbol;
+                    std::chrono::steady_clock::time_point produced;
+                };
+                std::vector<Pending> pending;
+                pending.reserve(std::max(1, batchSize));
+                
+                // Расписание открытого цикла не зависит от того, успевает ли поток:
+                // если он отстал, следующий запрос уже "пришёл" и ждёт в очереди
+                // В замкнутом цикле генератор не засевается (random_device дорог),
+                // а распределение не строится с λ = 0
+                std::mt19937_64 arrivals;
+                std::exponential_distribution<double> poissonGap;
+                std::chrono::nanoseconds fixedGap{0};
+                if (arrivalRate > 0) {
+                    arrivals.seed(std::random_device{}());
+                    poissonGap = std::exponential_distribution<double>(arrivalRate / numThreads);
+                    fixedGap = std::chrono::nanoseconds(static_cast<long long>(1e9 * numThreads / arrivalRate));
+                    threadLatency[i].reserve(iterations);
+                }
+                auto firstArrival = std::chrono::steady_clock::now();
+                auto intended = firstArrival;
+                
+                for (int j = 0; j < iterations; ++j) {
+                    // Пауза между захватами; в открытом цикле её роль играет расписание
+                    if (workload && arrivalRate <= 0) {
+                        long long think = workload->sampleThink(i, workloadRng);
+                        wc.thinkRequestedNs += think;
+                        wc.thinkNs += spendWorkloadTime(think);
+                    }
+                    if (arrivalRate > 0) {
+                        intended += poissonArrivals
+                            ? std::chrono::nanoseconds(static_cast<long long>(1e9 * poissonGap(arrivals)))
+                            : fixedGap;
+                        if (std::chrono::steady_clock::now() < intended) {
+                            std::this_thread::sleep_until(intended);
+                        }
+                    }
+                    if (batchSize > 0) {
+                        pending.push_back({generateRandomChar(), std::chrono::steady_clock::now()});
+                        if (static_cast<int>(pending.size()) < batchSize && j + 1 < iterations) {
+                            continue;
+                        }
+                    }
+                    
+                    bool toShared = !workload || workload->pickShared(workloadRng);
+                    auto& lock = toShared ? sharedLock : ownLock;
+                    ++(toShared ? wc.shared : wc.privateAcquisitions);
+                    lock.lock();
+                    if (batchSize > 0) {
+                        auto published = std::chrono::steady_clock::now();
+                        Staleness& st = threadStaleness[i];
+                        for (const auto& p : pending) {
+                            results[i] = p.symbol;
+                            long long age = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                published - p.produced).count();
+                            st.sumNs += age;
+                            st.maxNs = std::max(st.maxNs, age);
+                        }
+                        st.count += static_cast<long long>(pending.size());
+                        pending.clear();
+                    } else {
+                        results[i] = generateRandomChar();
+                    }
+                    if (slots) {
+                        slots[i].state.write({j + 1, results[i]});
+                    }
                     // Имитация работы
-                    std::this_thread::sleep_for(std::chrono::microseconds(10));
+                    if (workload) {
+                        long long hold = workload->sampleHold(i, workloadRng);
+                        wc.holdRequestedNs += hold;
+                        wc.holdNs += spendWorkloadTime(hold);
+                    } else if (holdMicros > 0) {
+                        std::this_thread::sleep_for(std::chrono::microseconds(holdMicros));
+                    }
+                    if (!workload && holdWorkNs > 0) {
+                        auto until = std::chrono::steady_clock::now() + std::chrono::nanoseconds(holdWorkNs);
+                        while (std::chrono::steady_clock::now() < until) {
+                            // Busy work
+                        }
+                    }
+                    lock.unlock();
+                    if (arrivalRate > 0) {
+                        // Время отклика: ожидание в очереди + захват + удержание
+                        threadLatency[i].push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - intended).count());
+                    }
+                }
+                RACE_TRACE_PHASE_END("race " + name);
+                if (arrivalRate > 0 && iterations > 0) {
+                    double scheduled = std::chrono::duration<double>(intended - firstArrival).count();
+                    double served = std::chrono::duration<double>(std::chrono::steady_clock::now() - firstArrival).count();
+                    threadRates[i].generated = scheduled > 0 ? iterations / scheduled : 0;
+                    threadRates[i].achieved = served > 0 ? iterations / served : 0;
                 }
                 
                 auto threadEnd = std::chrono::high_resolution_clock::now();
                 threadTimes[i] = std::chrono::duration_cast<std::chrono::microseconds>
                                 (threadEnd - threadStart).count();
+                threadCpu[i] = CpuUsage::thisThread() - cpuStart;
             });
         }
         
@@ -69,193 +407,494 @@ public:
         auto end = std::chrono::high_resolution_clock::now();
         auto totalTime = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
         
-        std::cout << "Mutex Test - Total time: " << totalTime << " microseconds\n";
+        if (observer.joinable()) {
+            raceDone.store(true, std::memory_order_release);
+            observer.join();
+        }
+        
+        std::cout << name << " Test - Total time: " << totalTime << " microseconds\n";
+        lastRun = RunEfficiency::fromThreads(totalTime / 1e6, 1LL * numThreads * raceLength, threadCpu);
+        lastRun.print();
+        lastStaleness = Staleness{};
+        for (const auto& st : threadStaleness) {
+            lastStaleness.sumNs += st.sumNs;
+            lastStaleness.maxNs = std::max(lastStaleness.maxNs, st.maxNs);
+            lastStaleness.count += st.count;
+        }
+        if (batchSize > 0) {
+            std::cout << "    Batch " << batchSize << ": staleness avg " 
+                      << static_cast<long long>(lastStaleness.avgNs()) << " ns, max " 
+                      << lastStaleness.maxNs << " ns\n";
+        }
+        if (arrivalRate > 0) {
+            std::vector<long long> all;
+            for (const auto& l : threadLatency) {
+                all.insert(all.end(), l.begin(), l.end());
+            }
+            std::sort(all.begin(), all.end());
+            lastOpenLoop.offered = arrivalRate;
+            lastOpenLoop.generated = 0;
+            lastOpenLoop.achieved = 0;
+            for (const auto& r : threadRates) {
+                lastOpenLoop.generated += r.generated;
+                lastOpenLoop.achieved += r.achieved;
+            }
+            lastOpenLoop.p50 = percentile(all, 0.50);
+            lastOpenLoop.p99 = percentile(all, 0.99);
+            lastOpenLoop.p999 = percentile(all, 0.999);
+            lastOpenLoop.max = all.empty() ? 0 : all.back();
+            std::cout << "    Open loop (" << (poissonArrivals ? "poisson" : "fixed") << "): offered "
+                      << static_cast<long long>(lastOpenLoop.offered) << " req/s, generated "
+                      << static_cast<long long>(lastOpenLoop.generated) << " req/s, achieved "
+                      << static_cast<long long>(lastOpenLoop.achieved) << " req/s, latency p50 "
+                      << lastOpenLoop.p50 << " ns, p99 " << lastOpenLoop.p99 << " ns, p99.9 "
+                      << lastOpenLoop.p999 << " ns, max " << lastOpenLoop.max << " ns\n";
+        }
+        if (workload) {
+            WorkloadCounters total;
+            for (const auto& c : threadWorkload) {
+                total.shared += c.shared;
+                total.privateAcquisitions += c.privateAcquisitions;
+                total.holdNs += c.holdNs;
+                total.thinkNs += c.thinkNs;
+                total.holdRequestedNs += c.holdRequestedNs;
+                total.thinkRequestedNs += c.thinkRequestedNs;
+            }
+            long long acquisitions = std::max(1LL, total.shared + total.privateAcquisitions);
+            std::cout << "    Workload " << workload->name << ": shared " << std::fixed << std::setprecision(1)
+                      << 100.0 * total.shared / acquisitions << "% of " << acquisitions
+                      << " acquisitions, avg hold " << total.holdNs / acquisitions
+                      << " ns (requested " << total.holdRequestedNs / acquisitions
+                      << "), avg think " << total.thinkNs / acquisitions
+                      << " ns (requested " << total.thinkRequestedNs / acquisitions << ")\n" << std::defaultfloat;
+        }
+        if (observerHz > 0) {
+            std::cout << "    Observer CPU " << std::fixed << std::setprecision(3) << observerCpu.cpuSec()
+                      << "s (" << std::setprecision(1)
+                      << 100.0 * observerCpu.cpuSec() / std::max(lastRun.cpu.cpuSec(), 1e-9)
+                      << "% of racers' CPU)\n" << std::defaultfloat;
+        }
     }
     
-    // Тест с использованием семафора 
-    void testWithSemaphore() {
-        std::counting_semaphore<1000> sem(1);
-        results.assign(numThreads, ' ');
-        threadTimes.assign(numThreads, 0);
-        threads.clear();
-        
-        auto start = std::chrono::high_resolution_clock::now();
-        
-        for (int i = 0; i < numThreads; ++i) {
-            threads.emplace_back([this, i, &sem]() {
-                auto threadStart = std::chrono::high_resolution_clock::now();
-                
-                for (int j = 0; j < raceLength; ++j) {
-                    sem.acquire();
-                    results[i] = generateRandomChar();
-                    std::this_thread::sleep_for(std::chrono::microseconds(10));
-                    sem.release();
+public:
+    // Общий прогон гонки на одной блокировке.
+    // Захват идёт через ProfiledLock, поэтому при включённом профилировщике
+    // каждый примитив попадает в отчёт под именем "ThreadRaceTest::<name>".
+    template <typename Lock>
+    void runLockRace(const std::string& name, Lock& rawLock) {
+        ProfiledLock<Lock> lock(rawLock, "ThreadRaceTest::" + name);
+        auto sharedFor = [&lock](int) -> ProfiledLock<Lock>& { return lock; };
+
+        // Собственные блокировки потоков того же типа - для захватов мимо общей
+        if constexpr (std::is_default_constructible_v<Lock>) {
+            if (workload && workload->sharedProbability < 1.0) {
+                struct alignas(64) PaddedLock {
+                    Lock lock;
+                };
+                std::unique_ptr<PaddedLock[]> own(new PaddedLock[numThreads]);
+                std::deque<ProfiledLock<Lock>> profiled;
+                for (int k = 0; k < numThreads; ++k) {
+                    profiled.emplace_back(own[k].lock, "ThreadRaceTest::" + name + " private");
                 }
-                
-                auto threadEnd = std::chrono::high_resolution_clock::now();
-                threadTimes[i] = std::chrono::duration_cast<std::chrono::microseconds>
-                                (threadEnd - threadStart).count();
-            });
+                raceLoop(name, sharedFor, [&profiled](int i) -> ProfiledLock<Lock>& { return profiled[i]; });
+                return;
+            }
+        } else if (workload && workload->sharedProbability < 1.0) {
+            std::cout << "    " << name << ": no private locks for this type, every acquisition is shared\n";
+        }
+        raceLoop(name, sharedFor);
+    }
+    
+    // Прогон с K полосами: ячейку results[i] защищает блокировка i % K.
+    // Блокировки выровнены по кэш-линии, чтобы полосы не делили одну линию.
+    template <typename Lock>
+    void runStripedRace(const std::string& name, int stripes) {
+        struct alignas(64) PaddedLock {
+            Lock lock;
+        };
+        std::unique_ptr<PaddedLock[]> locks(new PaddedLock[stripes]);
+        std::deque<ProfiledLock<Lock>> profiled;
+        for (int k = 0; k < stripes; ++k) {
+            profiled.emplace_back(locks[k].lock, "ThreadRaceTest::" + name + " striped");
+        }
+        raceLoop(name + " x" + std::to_string(stripes) + " stripes",
+                 [&profiled, stripes](int i) -> ProfiledLock<Lock>& { return profiled[i % stripes]; });
+    }
+    
+    // Развёртка гранулярности: для каждого примитива K = 1, 2, 4, ... numThreads
+    void testStripedGranularity() {
+        std::vector<int> stripeCounts;
+        for (int k = 1; k < numThreads; k *= 2) {
+            stripeCounts.push_back(k);
         }
+        stripeCounts.push_back(numThreads);
         
-        for (auto& t : threads) {
-            t.join();
+        forEachLockPrimitive([this, &stripeCounts]<typename Lock>(const std::string& name) {
+            std::vector<double> throughput;
+            for (int k : stripeCounts) {
+                runStripedRace<Lock>(name, k);
+                throughput.push_back(lastRun.throughput());
+            }
+            
+            std::cout << name << " granularity:";
+            for (size_t n = 0; n < stripeCounts.size(); ++n) {
+                std::cout << " K=" << stripeCounts[n] << " " << static_cast<long long>(throughput[n])
+                          << " acq/s (" << std::fixed << std::setprecision(2)
+                          << throughput[n] / throughput[0] << "x)" << std::defaultfloat;
+            }
+            std::cout << "\n\n";
+        });
+    }
+    
+    // Развёртка размера пакета k = 1..256 для каждого примитива.
+    // "Колено" - наименьшее k, после которого удвоение пакета даёт меньше 10% прироста.
+    void testBatchingSweep() {
+        int savedBatch = batchSize;
+        std::vector<int> sizes;
+        for (int k = 1; k <= 256; k *= 2) {
+            sizes.push_back(k);
         }
         
-        auto end = std::chrono::high_resolution_clock::now();
-        auto totalTime = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        forEachLockPrimitive([this, &sizes]<typename Lock>(const std::string& name) {
+            std::vector<double> throughput;
+            std::vector<double> staleness;
+            for (int k : sizes) {
+                batchSize = k;
+                Lock lock;
+                runLockRace(name + " batch " + std::to_string(k), lock);
+                throughput.push_back(lastRun.throughput());
+                staleness.push_back(lastStaleness.avgNs());
+            }
+            
+            int knee = sizes.back();
+            for (size_t n = 0; n + 1 < sizes.size(); ++n) {
+                if (throughput[n + 1] < throughput[n] * 1.10) {
+                    knee = sizes[n];
+                    break;
+                }
+            }
+            
+            std::cout << name << " batching:\n";
+            for (size_t n = 0; n < sizes.size(); ++n) {
+                std::cout << "    k=" << std::setw(3) << sizes[n] << "  " << std::setw(12) 
+                          << static_cast<long long>(throughput[n]) << " upd/s  staleness avg "
+                          << static_cast<long long>(staleness[n]) << " ns\n";
+            }
+            std::cout << "    knee at k=" << knee << "\n\n";
+        });
+        batchSize = savedBatch;
+    }
+    
+    // Кривая "задержка от нагрузки" в открытом цикле: частота удваивается от
+    // startRate, пока примитив не насытится. Насыщение - обслуженная частота ниже
+    // 90% сгенерированной (очередь растёт) или p99 в 10 раз выше, чем на самой
+    // низкой частоте.
+    // Каждая ступень длится около stepSeconds (raceLength подбирается под частоту).
+    void testOpenLoopSweep(double startRate = 1000, double stepSeconds = 0.25, bool poisson = true) {
+        double savedRate = arrivalRate;
+        bool savedPoisson = poissonArrivals;
+        int savedLength = raceLength;
+        
+        forEachLockPrimitive([&]<typename Lock>(const std::string& name) {
+            std::vector<OpenLoopStats> curve;
+            double saturation = 0;
+            for (double rate = startRate; curve.size() < 24; rate *= 2) {
+                setArrivalRate(rate, poisson);
+                raceLength = std::max(20, static_cast<int>(rate * stepSeconds / numThreads));
+                Lock lock;
+                runLockRace(name + " open loop", lock);
+                curve.push_back(lastOpenLoop);
+                if (lastOpenLoop.achieved < 0.9 * lastOpenLoop.generated || lastOpenLoop.p99 > 10 * curve.front().p99) {
+                    saturation = rate;
+                    break;
+                }
+            }
+            
+            std::cout << name << " latency vs load (" << (poisson ? "poisson" : "fixed") << " arrivals):\n";
+            for (const auto& point : curve) {
+                std::cout << "    offered " << std::setw(9) << static_cast<long long>(point.offered)
+                          << "  achieved " << std::setw(9) << static_cast<long long>(point.achieved)
+                          << "  p50 " << std::setw(10) << point.p50
+                          << "  p99 " << std::setw(10) << point.p99
+                          << "  p99.9 " << std::setw(10) << point.p999 << " ns\n";
+            }
+            if (saturation > 0) {
+                std::cout << "    saturated at " << static_cast<long long>(saturation) << " req/s\n\n";
+            } else {
+                std::cout << "    not saturated up to " << static_cast<long long>(curve.back().offered) << " req/s\n\n";
+            }
+        });
         
-        std::cout << "Semaphore Test - Total time: " << totalTime << " microseconds\n";
+        arrivalRate = savedRate;
+        poissonArrivals = savedPoisson;
+        raceLength = savedLength;
     }
     
-    // Тест с использованием барьера 
-    void testWithBarrier() {
-        std::barrier syncPoint(numThreads);
-        results.assign(numThreads, ' ');
-        threadTimes.assign(numThreads, 0);
-        threads.clear();
+    // Адаптивная блокировка против TAS, MCS и мьютекса на сетке
+    // "число потоков (1, 2, 4 ... numThreads) x длина критической секции".
+    // Для каждой клетки печатается пропускная способность и доля от лучшей статической.
+    void testAdaptiveGrid() {
+        struct Section {
+            const char* name;
+            int sleepMicros;
+            int workNs;
+        };
+        const Section sections[] = {
+            {"empty", 0, 0},
+            {"busy 1us", 0, 1000},
+            {"busy 10us", 0, 10000},
+            {"sleep 50us", 50, 0},
+        };
+        std::vector<int> threadCounts;
+        for (int t = 1; t < numThreads; t *= 2) {
+            threadCounts.push_back(t);
+        }
+        threadCounts.push_back(numThreads);
         
-        auto start = std::chrono::high_resolution_clock::now();
+        struct Cell {
+            int threads;
+            const char* section;
+            double tas, mcs, mutex, adaptive;
+            std::string finalMode;
+            long long switches;
+        };
+        std::vector<Cell> grid;
         
-        for (int i = 0; i < numThreads; ++i) {
-            threads.emplace_back([this, i, &syncPoint]() {
-                auto threadStart = std::chrono::high_resolution_clock::now();
+        for (const auto& section : sections) {
+            for (int t : threadCounts) {
+                ThreadRaceTest cell(t, raceLength);
+                cell.setHoldTime(section.sleepMicros);
+                cell.setHoldWork(section.workNs);
+                auto measure = [&cell]<typename Lock>(const std::string& name, Lock& lock) {
+                    cell.runLockRace(name, lock);
+                    return cell.lastEfficiency().throughput();
+                };
                 
-                for (int j = 0; j < raceLength; ++j) {
-                    results[i] = generateRandomChar();
-                    std::this_thread::sleep_for(std::chrono::microseconds(10));
-                    syncPoint.arrive_and_wait();
+                std::cout << "--- " << t << " threads, " << section.name << " ---\n";
+                Cell c{t, section.name, 0, 0, 0, 0, "", 0};
+                {
+                    TasSpinLock lock;
+                    c.tas = measure("TAS", lock);
                 }
-                
-                auto threadEnd = std::chrono::high_resolution_clock::now();
-                threadTimes[i] = std::chrono::duration_cast<std::chrono::microseconds>
-                                (threadEnd - threadStart).count();
-            });
+                {
+                    McsLock lock;
+                    c.mcs = measure("MCS", lock);
+                }
+                {
+                    std::mutex lock;
+                    c.mutex = measure("Mutex", lock);
+                }
+                {
+                    AdaptiveLock lock;
+                    c.adaptive = measure("Adaptive", lock);
+                    lock.printStats();
+                    c.finalMode = AdaptiveLock::modeName(lock.currentMode());
+                    c.switches = lock.switchCount();
+                }
+                grid.push_back(c);
+            }
         }
         
-        for (auto& t : threads) {
-            t.join();
+        std::cout << "\n=== Adaptive lock grid (acq/s) ===\n";
+        std::cout << std::left << std::setw(12) << "section" << std::right << std::setw(8) << "threads"
+                  << std::setw(12) << "TAS" << std::setw(12) << "MCS" << std::setw(12) << "Mutex"
+                  << std::setw(12) << "Adaptive" << "  vs best  mode\n";
+        for (const auto& c : grid) {
+            double best = std::max({c.tas, c.mcs, c.mutex});
+            std::cout << std::left << std::setw(12) << c.section << std::right << std::setw(8) << c.threads
+                      << std::setw(12) << static_cast<long long>(c.tas)
+                      << std::setw(12) << static_cast<long long>(c.mcs)
+                      << std::setw(12) << static_cast<long long>(c.mutex)
+                      << std::setw(12) << static_cast<long long>(c.adaptive)
+                      << std::fixed << std::setprecision(2) << std::setw(8) << c.adaptive / best << "x  "
+                      << std::defaultfloat << c.finalMode << " (" << c.switches << " switches)\n";
         }
-        
-        auto end = std::chrono::high_resolution_clock::now();
-        auto totalTime = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-        
-        std::cout << "Barrier Test - Total time: " << totalTime << " microseconds\n";
     }
     
-    // Тест со SpinLock
-    void testWithSpinLock() {
-        std::atomic_flag lock = ATOMIC_FLAG_INIT;
-        results.assign(numThreads, ' ');
-        threadTimes.assign(numThreads, 0);
-        threads.clear();
-        
-        auto start = std::chrono::high_resolution_clock::now();
+    // Нативные типы мьютексов glibc против std::mutex при 1, 2, 4 ... numThreads потоках.
+    // Итоговая таблица - пропускная способность относительно std::mutex (>1 - быстрее).
+    void testPthreadBackends() {
+        std::vector<int> threadCounts;
+        for (int t = 1; t < numThreads; t *= 2) {
+            threadCounts.push_back(t);
+        }
+        threadCounts.push_back(numThreads);
         
-        for (int i = 0; i < numThreads; ++i) {
-            threads.emplace_back([this, i, &lock]() {
-                auto threadStart = std::chrono::high_resolution_clock::now();
-                
-                for (int j = 0; j < raceLength; ++j) {
-                    while (lock.test_and_set(std::memory_order_acquire)) {
-                        // Spin wait
-                    }
-                    results[i] = generateRandomChar();
-                    std::this_thread::sleep_for(std::chrono::microseconds(10));
-                    lock.clear(std::memory_order_release);
+        std::vector<std::string> names{"std::mutex"};
+        std::vector<std::vector<double>> throughput(1);
+        for (int t : threadCounts) {
+            std::cout << "--- " << t << " threads ---\n";
+            ThreadRaceTest cell(t, raceLength);
+            cell.setHoldTime(holdMicros);
+            cell.setHoldWork(holdWorkNs);
+            {
+                std::mutex mtx;
+                cell.runLockRace("std::mutex", mtx);
+                throughput[0].push_back(cell.lastEfficiency().throughput());
+            }
+            size_t row = 1;
+            forEachPthreadLock([&]<typename Lock>(const std::string& name) {
+                Lock lock;
+                cell.runLockRace(name, lock);
+                if (row == names.size()) {
+                    names.push_back(name);
+                    throughput.emplace_back();
                 }
-                
-                auto threadEnd = std::chrono::high_resolution_clock::now();
-                threadTimes[i] = std::chrono::duration_cast<std::chrono::microseconds>
-                                (threadEnd - threadStart).count();
+                throughput[row++].push_back(cell.lastEfficiency().throughput());
             });
         }
         
-        for (auto& t : threads) {
-            t.join();
+        std::cout << "\n=== pthread backends vs std::mutex (throughput ratio) ===\n";
+        std::cout << std::left << std::setw(26) << "threads" << std::right;
+        for (int t : threadCounts) {
+            std::cout << std::setw(8) << t;
+        }
+        std::cout << "\n";
+        for (size_t r = 0; r < names.size(); ++r) {
+            std::cout << std::left << std::setw(26) << names[r] << std::right << std::fixed << std::setprecision(2);
+            for (size_t n = 0; n < threadCounts.size(); ++n) {
+                std::cout << std::setw(8) << throughput[r][n] / throughput[0][n];
+            }
+            std::cout << std::defaultfloat << "\n";
         }
-        
-        auto end = std::chrono::high_resolution_clock::now();
-        auto totalTime = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-        
-        std::cout << "SpinLock Test - Total time: " << totalTime << " microseconds\n";
     }
     
-    // Тест с SpinWait
-    void testWithSpinWait() {
-        std::atomic<bool> lock(false);
-        results.assign(numThreads, ' ');
-        threadTimes.assign(numThreads, 0);
-        threads.clear();
+    // SpinWait (SpinWait.h) против прежних самодельных циклов ожидания при
+    // 1, 2, 4 ... numThreads потоках. Для спина важна не только пропускная
+    // способность, но и сожжённый процессор, поэтому печатаются оба.
+    void testSpinWaitPolicies() {
+        std::vector<int> threadCounts;
+        for (int t = 1; t < numThreads; t *= 2) {
+            threadCounts.push_back(t);
+        }
+        threadCounts.push_back(numThreads);
         
-        auto start = std::chrono::high_resolution_clock::now();
+        const char* names[] = {
+            "TAS pure spin",
+            "yield every attempt",
+            "j % 100 yield (old)",
+            "SpinWait escalating",
+            "SpinWait no park",
+        };
+        constexpr size_t variants = sizeof(names) / sizeof(names[0]);
+        std::vector<RunEfficiency> runs[variants];
         
-        for (int i = 0; i < numThreads; ++i) {
-            threads.emplace_back([this, i, &lock]() {
-                auto threadStart = std::chrono::high_resolution_clock::now();
-                
-                for (int j = 0; j < raceLength; ++j) {
-                    bool expected = false;
-                    while (!lock.compare_exchange_weak(expected, true, 
-                            std::memory_order_acquire, std::memory_order_relaxed)) {
-                        expected = false;
-                        // Spin wait with potential yield
-                        if (j % 100 == 0) {
-                            std::this_thread::yield();
-                        }
-                    }
-                    results[i] = generateRandomChar();
-                    std::this_thread::sleep_for(std::chrono::microseconds(10));
-                    lock.store(false, std::memory_order_release);
-                }
-                
-                auto threadEnd = std::chrono::high_resolution_clock::now();
-                threadTimes[i] = std::chrono::duration_cast<std::chrono::microseconds>
-                                (threadEnd - threadStart).count();
-            });
+        for (int t : threadCounts) {
+            std::cout << "--- " << t << " threads ---\n";
+            ThreadRaceTest cell(t, raceLength);
+            cell.setHoldTime(holdMicros);
+            cell.setHoldWork(holdWorkNs);
+            auto measure = [&cell, &runs, &names](size_t v, auto& lock) {
+                cell.runLockRace(names[v], lock);
+                runs[v].push_back(cell.lastEfficiency());
+            };
+            {
+                TasSpinLock lock;
+                measure(0, lock);
+            }
+            {
+                YieldSpinLock lock;
+                measure(1, lock);
+            }
+            {
+                ModuloYieldSpinLock lock;
+                measure(2, lock);
+            }
+            {
+                SpinWaitLock lock;
+                measure(3, lock);
+            }
+            {
+                SpinWaitLock lock(SpinPolicy::escalating().withoutPark());
+                measure(4, lock);
+            }
         }
         
-        for (auto& t : threads) {
-            t.join();
+        std::cout << "\n=== SpinWait vs ad hoc loops: acq/s | CPU-s per 1M acq ===\n";
+        std::cout << std::left << std::setw(22) << "threads" << std::right;
+        for (int t : threadCounts) {
+            std::cout << std::setw(22) << t;
+        }
+        std::cout << "\n";
+        for (size_t v = 0; v < variants; ++v) {
+            std::cout << std::left << std::setw(22) << names[v] << std::right;
+            for (const auto& run : runs[v]) {
+                std::cout << std::setw(12) << static_cast<long long>(run.throughput()) << " | "
+                          << std::fixed << std::setprecision(3) << std::setw(6) << run.cpuSecPerMillion()
+                          << std::defaultfloat;
+            }
+            std::cout << "\n";
         }
-        
-        auto end = std::chrono::high_resolution_clock::now();
-        auto totalTime = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-        
-        std::cout << "SpinWait Test - Total time: " << totalTime << " microseconds\n";
     }
     
-    // Тест с монитором (условная переменная + мьютекс)
-    void testWithMonitor() {
+    // Перекошенный доступ: смещённая блокировка против мьютекса и SpinLock.
+    // Поток 0 стартует первым и обычно становится владельцем смещения.
+    void testBiasedSkew(int percent) {
+        int savedSkew = skewPercent;
+        skewPercent = percent;
+        std::cout << "--- Skew: thread 0 does " << percent << "% of acquisitions ---\n";
+        {
+            std::mutex mtx;
+            runLockRace("Mutex skew", mtx);
+        }
+        {
+            TasSpinLock lock;
+            runLockRace("SpinLock skew", lock);
+        }
+        {
+            BiasedLock lock;
+            runLockRace("BiasedLock skew", lock);
+            lock.printStats();
+        }
+        skewPercent = savedSkew;
+    }
+    
+    // Тест с использованием мьютекса
+    void testWithMutex() {
         std::mutex mtx;
-        std::condition_variable cv;
-        bool ready = true;
+        runLockRace("Mutex", mtx);
+    }
+    
+    // Тест с использованием семафора 
+    void testWithSemaphore() {
+        std::counting_semaphore<1000> sem(1);
+        runLockRace("Semaphore", sem);
+    }
+    
+    // Тест с семафором без мьютекса (FastSemaphore.h)
+    void testWithFastSemaphore() {
+        FastSemaphore sem(1);
+        runLockRace("FastSemaphore", sem);
+    }
+    
+    // Тест с использованием барьера 
+    void testWithBarrier() {
+        std::barrier rawBarrier(numThreads);
+        ProfiledBarrier syncPoint(rawBarrier, "ThreadRaceTest::Barrier");
         results.assign(numThreads, ' ');
         threadTimes.assign(numThreads, 0);
+        threadCpu.assign(numThreads, CpuUsage{});
         threads.clear();
         
         auto start = std::chrono::high_resolution_clock::now();
         
         for (int i = 0; i < numThreads; ++i) {
-            threads.emplace_back([this, i, &mtx, &cv, &ready]() {
+            threads.emplace_back([this, i, &syncPoint]() {
                 auto threadStart = std::chrono::high_resolution_clock::now();
+                CpuUsage cpuStart = CpuUsage::thisThread();
+                RACE_TRACE_PHASE_BEGIN("race Barrier");
                 
                 for (int j = 0; j < raceLength; ++j) {
-                    std::unique_lock<std::mutex> lock(mtx);
-                    cv.wait(lock, [&ready]() { return ready; });
-                    ready = false;
-                    
                     results[i] = generateRandomChar();
                     std::this_thread::sleep_for(std::chrono::microseconds(10));
-                    
-                    ready = true;
-                    lock.unlock();
-                    cv.notify_one();
+                    syncPoint.arrive_and_wait();
                 }
+                RACE_TRACE_PHASE_END("race Barrier");
                 
                 auto threadEnd = std::chrono::high_resolution_clock::now();
                 threadTimes[i] = std::chrono::duration_cast<std::chrono::microseconds>
                                 (threadEnd - threadStart).count();
+                threadCpu[i] = CpuUsage::thisThread() - cpuStart;
             });
         }
         
@@ -266,7 +905,47 @@ public:
         auto end = std::chrono::high_resolution_clock::now();
         auto totalTime = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
         
-        std::cout << "Monitor Test - Total time: " << totalTime << " microseconds\n";
+        std::cout << "Barrier Test - Total time: " << totalTime << " microseconds\n";
+        lastRun = RunEfficiency::fromThreads(totalTime / 1e6, 1LL * numThreads * raceLength, threadCpu);
+        lastRun.print();
+    }
+    
+    // Тест со SpinLock
+    void testWithSpinLock() {
+        TasSpinLock lock;
+        runLockRace("SpinLock", lock);
+    }
+    
+    // Тест с SpinWait
+    void testWithSpinWait() {
+        SpinWaitLock lock;
+        runLockRace("SpinWait", lock);
+    }
+    
+    // Профиль нагрузки на всех примитивах forEachLockPrimitive (см. setWorkload)
+    void testWorkload(const WorkloadSpec& spec) {
+        std::optional<WorkloadSpec> saved = workload;
+        workload = spec;
+        std::cout << "=== Workload " << spec.describe() << " ===\n";
+        forEachLockPrimitive([this]<typename Lock>(const std::string& name) {
+            Lock lock;
+            runLockRace(name, lock);
+        });
+        workload = saved;
+    }
+
+    // Все сочетания RMW-операции и порядков памяти для spin-блокировки (SpinPrimitives.h)
+    void testSpinOrderingMatrix() {
+        forEachSpinOrdering([this]<typename Lock>() {
+            Lock lock;
+            runLockRace(Lock::name(), lock);
+        });
+    }
+    
+    // Тест с монитором (условная переменная + мьютекс)
+    void testWithMonitor() {
+        CondVarMonitorLock monitor;
+        runLockRace("Monitor", monitor);
     }
     
     // Запуск всех тестов
@@ -276,9 +955,14 @@ public:
         
         testWithMutex();
         testWithSemaphore();
+        testWithFastSemaphore();
         testWithBarrier();
         testWithSpinLock();
         testWithSpinWait();
         testWithMonitor();
+        
+        if (LockProfiler::isEnabled()) {
+            LockProfiler::instance().report();
+        }
     }
 };
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Подгонка развёртки по числу потоков под универсальный закон масштабируемости
+// (USL, Gunther) и закон Амдала:
+//   USL:    X(N) = lambda * N / (1 + sigma * (N - 1) + kappa * N * (N - 1))
+//   Amdahl: то же при kappa = 0
+// sigma in [0, 1] - доля сериализации (конкуренция), kappa - цена согласования (когерентность
+// кэшей, пересылка линий между ядрами). При kappa > 0 у кривой есть максимум в
+// N* = sqrt((1 - sigma) / kappa), дальше добавление потоков только вредит.
+
+struct ScalingPoint {
+    int threads;
+    double throughput;
+};
+
+struct ScalingFit {
+    double lambda = 0; // пропускная способность одного потока без помех
+    double sigma = 0;
+    double kappa = 0;
+    double r2 = 0;
+
+    double predict(double n) const {
+        return lambda * n / (1 + sigma * (n - 1) + kappa * n * (n - 1));
+    }
+
+    // Непрерывная точка максимума (не меньше 1); 0 - максимума нет (kappa = 0)
+    double peakThreads() const {
+        return kappa > 0 ? std::max(1.0, std::sqrt(std::max(0.0, 1 - sigma) / kappa)) : 0;
+    }
+
+    // Колено: первое N, где каждый поток даёт меньше половины линейного вклада
+    int kneeThreads(int limit = 1024) const {
+        for (int n = 1; n <= limit; ++n) {
+            if (predict(n) / (lambda * n) < 0.5) {
+                return n;
+            }
+        }
+        return 0;
+    }
+};
+
+namespace scaling_detail {
+    // При фиксированном lambda: lambda*N/X - 1 = sigma*(N-1) + kappa*N*(N-1) -
+    // линейные наименьшие квадраты без свободного члена, с ограничением >= 0
+    inline void solveLinear(const std::vector<ScalingPoint>& points, double lambda, bool withKappa,
+                            double& sigma, double& kappa) {
+        double saa = 0, sab = 0, sbb = 0, say = 0, sby = 0;
+        for (const auto& p : points) {
+            double n = p.threads;
+            double y = lambda * n / p.throughput - 1;
+            double a = n - 1;
+            double b = n * (n - 1);
+            saa += a * a;
+            sab += a * b;
+            sbb += b * b;
+            say += a * y;
+            sby += b * y;
+        }
+        sigma = 0;
+        kappa = 0;
+        double det = saa * sbb - sab * sab;
+        if (withKappa && std::fabs(det) > 1e-12) {
+            sigma = (say * sbb - sby * sab) / det;
+            kappa = (saa * sby - sab * say) / det;
+        }
+        if (!withKappa || sigma < 0 || kappa < 0) {
+            // Граница области: одна из переменных равна нулю
+            double onlySigma = saa > 0 ? std::max(0.0, say / saa) : 0;
+            double onlyKappa = (withKappa && sbb > 0) ? std::max(0.0, sby / sbb) : 0;
+            auto sse = [&](double s, double k) {
+                double e = 0;
+                for (const auto& p : points) {
+                    double n = p.threads;
+                    double d = lambda * n / p.throughput - 1 - s * (n - 1) - k * n * (n - 1);
+                    e += d * d;
+                }
+                return e;
+            };
+            if (withKappa && sse(0, onlyKappa) < sse(onlySigma, 0)) {
+                sigma = 0;
+                kappa = onlyKappa;
+            } else {
+                sigma = onlySigma;
+                kappa = 0;
+            }
+        }
+        if (sigma > 1) {
+            // Сериализация больше полной - модель вне области; фиксируем sigma = 1
+            sigma = 1;
+            kappa = (withKappa && sbb > 0) ? std::max(0.0, (sby - sab) / sbb) : 0;
+        }
+    }
+
+    inline double r2(const std::vector<ScalingPoint>& points, const ScalingFit& fit) {
+        double mean = 0;
+        for (const auto& p : points) {
+            mean += p.throughput;
+        }
+        mean /= points.size();
+        double ssRes = 0, ssTot = 0;
+        for (const auto& p : points) {
+            double d = p.throughput - fit.predict(p.threads);
+            ssRes += d * d;
+            ssTot += (p.throughput - mean) * (p.throughput - mean);
+        }
+        return ssTot > 0 ? 1 - ssRes / ssTot : 1;
+    }
+}
+
+// lambda подбирается перебором по логарифмической сетке от max(X/N)
+// (меньше быть не может при sigma, kappa >= 0) до 4 * max(X/N)
+inline ScalingFit fitScaling(const std::vector<ScalingPoint>& points, bool withKappa = true) {
+    ScalingFit best;
+    if (points.empty()) {
+        return best;
+    }
+    double base = 0;
+    for (const auto& p : points) {
+        base = std::max(base, p.throughput / p.threads);
+    }
+    double bestSse = -1;
+    const int steps = 400;
+    for (int i = 0; i <= steps; ++i) {
+        ScalingFit fit;
+        fit.lambda = base * std::pow(4.0, static_cast<double>(i) / steps);
+        scaling_detail::solveLinear(points, fit.lambda, withKappa, fit.sigma, fit.kappa);
+        double sse = 0;
+        for (const auto& p : points) {
+            double d = p.throughput - fit.predict(p.threads);
+            sse += d * d;
+        }
+        if (bestSse < 0 || sse < bestSse) {
+            bestSse = sse;
+            best = fit;
+        }
+    }
+    best.r2 = scaling_detail::r2(points, best);
+    return best;
+}
+
+// Ниже этого R^2 подгонка USL считается ненадёжной: пик и колено не печатаются
+constexpr double kReliableFitR2 = 0.8;
+
+// Отчёт по одному примитиву: USL, Амдал, предсказанный пик и колено
+inline void printScalingReport(const std::string& name, const std::vector<ScalingPoint>& points,
+                               std::ostream& out = std::cout) {
+    ScalingFit usl = fitScaling(points, true);
+    ScalingFit amdahl = fitScaling(points, false);
+    int maxMeasured = 0;
+    for (const auto& p : points) {
+        maxMeasured = std::max(maxMeasured, p.threads);
+    }
+
+    out << name << ":\n" << std::setprecision(4)
+        << "    USL    lambda " << static_cast<long long>(usl.lambda) << " acq/s, sigma " << usl.sigma
+        << ", kappa " << usl.kappa << ", R^2 " << usl.r2 << "\n"
+        << "    Amdahl lambda " << static_cast<long long>(amdahl.lambda) << " acq/s, sigma " << amdahl.sigma
+        << ", R^2 " << amdahl.r2 << ", ceiling "
+        << (amdahl.sigma > 0 ? std::to_string(static_cast<long long>(amdahl.lambda / amdahl.sigma)) : "none")
+        << " acq/s\n";
+
+    if (usl.r2 < kReliableFitR2) {
+        out << "    UNRELIABLE fit (USL R^2 " << std::setprecision(3) << usl.r2 << " < " << kReliableFitR2
+            << "): no peak/knee prediction - measure longer runs or more repetitions\n" << std::defaultfloat;
+        return;
+    }
+    double peak = usl.peakThreads();
+    if (peak > 0) {
+        int rounded = std::max(1, static_cast<int>(std::lround(peak)));
+        out << "    predicted peak at N* = " << std::setprecision(3) << peak << " (" << rounded << " threads, "
+            << static_cast<long long>(usl.predict(rounded)) << " acq/s)"
+            << (rounded > maxMeasured ? " - beyond the measured range" : "") << "\n";
+    } else {
+        out << "    no peak (kappa = 0): throughput approaches "
+            << (usl.sigma > 0 ? std::to_string(static_cast<long long>(usl.lambda / usl.sigma)) + " acq/s"
+                              : "linear scaling")
+            << "\n";
+    }
+    int knee = usl.kneeThreads();
+    if (knee > 0) {
+        out << "    knee at " << knee << " threads (per-thread yield below 50% of linear)"
+            << (knee <= maxMeasured ? "" : " - beyond the measured range") << "\n";
+    } else {
+        out << "    no knee up to 1024 threads\n";
+    }
+    out << std::defaultfloat;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Seqlock для одного писателя и любого числа читателей.
+// Писатель никогда не ждёт; читатель повторяет чтение, если во время копирования
+// шла запись (номер нечётный или изменился). Данные хранятся в атомарных словах,
+// читаются relaxed-загрузками и отделяются барьерами - так чтение во время
+// записи не является гонкой данных.
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock needs a trivially copyable type");
+
+private:
+    static constexpr size_t kWords = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    std::atomic<unsigned> sequence{0};
+    std::atomic<std::uint64_t> words[kWords] = {};
+
+public:
+    SeqLock() = default;
+
+    explicit SeqLock(const T& initial) {
+        write(initial);
+    }
+
+    // Только один поток-писатель на объект
+    void write(const T& value) {
+        std::uint64_t buffer[kWords] = {};
+        std::memcpy(buffer, &value, sizeof(T));
+
+        unsigned seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t w = 0; w < kWords; ++w) {
+            words[w].store(buffer[w], std::memory_order_relaxed);
+        }
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    // Одна попытка; false - попали на запись, нужно повторить
+    bool tryRead(T& out) const {
+        unsigned before = sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            return false;
+        }
+        std::uint64_t buffer[kWords];
+        for (size_t w = 0; w < kWords; ++w) {
+            buffer[w] = words[w].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) != before) {
+            return false;
+        }
+        std::memcpy(&out, buffer, sizeof(T));
+        return true;
+    }
+
+    // Читает согласованную копию; retries - сколько раз пришлось повторить
+    T read(long long* retries = nullptr) const {
+        T value;
+        while (!tryRead(value)) {
+            if (retries) {
+                ++*retries;
+            }
+        }
+        return value;
+    }
+};
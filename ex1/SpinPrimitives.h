@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <type_traits>
+#include "SpinWait.h"
+
+// Spin-примитивы, параметризованные на этапе компиляции видом RMW-операции
+// и порядками памяти захвата/освобождения. Все сочетания перебирает
+// forEachSpinOrdering(), чтобы прогнать их под одинаковой нагрузкой.
+
+enum class RmwFlavor {
+    Tas,       // atomic_flag::test_and_set
+    Exchange,  // atomic<bool>::exchange(true)
+    CasWeak,   // compare_exchange_weak(false -> true)
+    CasStrong  // compare_exchange_strong(false -> true)
+};
+
+inline const char* rmwFlavorName(RmwFlavor flavor) {
+    switch (flavor) {
+        case RmwFlavor::Tas: return "TAS";
+        case RmwFlavor::Exchange: return "exchange";
+        case RmwFlavor::CasWeak: return "CAS-weak";
+        case RmwFlavor::CasStrong: return "CAS-strong";
+    }
+    return "?";
+}
+
+inline const char* memoryOrderName(std::memory_order order) {
+    switch (order) {
+        case std::memory_order_relaxed: return "relaxed";
+        case std::memory_order_consume: return "consume";
+        case std::memory_order_acquire: return "acquire";
+        case std::memory_order_release: return "release";
+        case std::memory_order_acq_rel: return "acq_rel";
+        case std::memory_order_seq_cst: return "seq_cst";
+    }
+    return "?";
+}
+
+template <RmwFlavor Flavor,
+          std::memory_order LockOrder = std::memory_order_acquire,
+          std::memory_order UnlockOrder = std::memory_order_release>
+class OrderedSpinLock {
+    static_assert(LockOrder == std::memory_order_acquire || LockOrder == std::memory_order_acq_rel ||
+                  LockOrder == std::memory_order_seq_cst, "lock needs at least acquire ordering");
+    static_assert(UnlockOrder == std::memory_order_release || UnlockOrder == std::memory_order_seq_cst,
+                  "unlock needs at least release ordering");
+
+private:
+    std::conditional_t<Flavor == RmwFlavor::Tas, std::atomic_flag, std::atomic<bool>> flag{};
+
+public:
+    bool try_lock() {
+        if constexpr (Flavor == RmwFlavor::Tas) {
+            return !flag.test_and_set(LockOrder);
+        } else if constexpr (Flavor == RmwFlavor::Exchange) {
+            return !flag.exchange(true, LockOrder);
+        } else if constexpr (Flavor == RmwFlavor::CasWeak) {
+            bool expected = false;
+            return flag.compare_exchange_weak(expected, true, LockOrder, std::memory_order_relaxed);
+        } else {
+            bool expected = false;
+            return flag.compare_exchange_strong(expected, true, LockOrder, std::memory_order_relaxed);
+        }
+    }
+
+    void lock() {
+        SpinWait spin(SpinPolicy::spinOnly());
+        while (!try_lock()) {
+            spin.spinOnce();
+        }
+    }
+
+    void unlock() {
+        if constexpr (Flavor == RmwFlavor::Tas) {
+            flag.clear(UnlockOrder);
+        } else {
+            flag.store(false, UnlockOrder);
+        }
+    }
+
+    static std::string name() {
+        return std::string("Spin<") + rmwFlavorName(Flavor) + "," +
+               memoryOrderName(LockOrder) + "/" + memoryOrderName(UnlockOrder) + ">";
+    }
+};
+
+namespace spin_primitives_detail {
+
+template <RmwFlavor Flavor, std::memory_order LockOrder, typename F>
+void forEachUnlockOrder(F& f) {
+    f.template operator()<OrderedSpinLock<Flavor, LockOrder, std::memory_order_release>>();
+    f.template operator()<OrderedSpinLock<Flavor, LockOrder, std::memory_order_seq_cst>>();
+}
+
+template <RmwFlavor Flavor, typename F>
+void forEachLockOrder(F& f) {
+    forEachUnlockOrder<Flavor, std::memory_order_acquire>(f);
+    forEachUnlockOrder<Flavor, std::memory_order_acq_rel>(f);
+    forEachUnlockOrder<Flavor, std::memory_order_seq_cst>(f);
+}
+
+} // namespace spin_primitives_detail
+
+// Вызывает f.template operator()<Lock>() для каждого из 24 сочетаний
+// (4 вида RMW x 3 порядка захвата x 2 порядка освобождения)
+template <typename F>
+void forEachSpinOrdering(F&& f) {
+    using namespace spin_primitives_detail;
+    forEachLockOrder<RmwFlavor::Tas>(f);
+    forEachLockOrder<RmwFlavor::Exchange>(f);
+    forEachLockOrder<RmwFlavor::CasWeak>(f);
+    forEachLockOrder<RmwFlavor::CasStrong>(f);
+}
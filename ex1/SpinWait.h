@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Подсказка процессору, что идёт цикл ожидания (PAUSE на x86): меньше
+// спекулятивных загрузок и больше ресурсов соседнему SMT-потоку
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#endif
+}
+
+// Фазы ожидания для SpinWait. Число в каждой фазе - сколько неудачных попыток
+// она длится; после всех фаз - парковка на futex (если park) или сон дальше.
+struct SpinPolicy {
+    int pauseRounds = 10;  // попытки с PAUSE; на k-й попытке 2^k пауз, не больше maxPauses
+    int maxPauses = 64;
+    int yieldRounds = 10;  // затем sched_yield
+    int sleepRounds = 5;   // затем короткий сон
+    std::chrono::microseconds sleep{50};
+    bool park = true;      // затем спать в ядре до пробуждения владельцем
+
+    // Как SpinWait в .NET: пауза -> yield -> сон -> парковка
+    static constexpr SpinPolicy escalating() {
+        return SpinPolicy{};
+    }
+
+    // Только PAUSE, без уступки процессора (классический TAS-спин)
+    static constexpr SpinPolicy spinOnly() {
+        return SpinPolicy{INT_MAX, 1, 0, 0, std::chrono::microseconds{0}, false};
+    }
+
+    // yield после каждой неудачи (spinwait_worker из test.cpp)
+    static constexpr SpinPolicy yieldOnly() {
+        return SpinPolicy{0, 1, INT_MAX, 0, std::chrono::microseconds{0}, false};
+    }
+
+    // Короткий спин, затем yield без сна - для передачи "из рук в руки" (MCS)
+    static constexpr SpinPolicy handoff() {
+        return SpinPolicy{10, 64, INT_MAX, 0, std::chrono::microseconds{0}, false};
+    }
+
+    constexpr SpinPolicy withoutPark() const {
+        SpinPolicy p = *this;
+        p.park = false;
+        return p;
+    }
+};
+
+// Счётчик одного ожидания: каждый spinOnce() - одна неудачная попытка,
+// фаза выбирается по числу попыток, а не по внешним индексам цикла.
+// Объект живёт на стеке ожидающего и сбрасывается на каждое новое ожидание.
+class SpinWait {
+private:
+    SpinPolicy policy;
+    long long count = 0;
+
+public:
+    explicit SpinWait(const SpinPolicy& spinPolicy = SpinPolicy::escalating()) : policy(spinPolicy) {}
+
+    // Одна итерация ожидания. false - фазы исчерпаны и политика разрешает
+    // парковку: примитив, который умеет будить, должен уснуть на futex.
+    // Примитив без пробуждения может просто вызывать spinOnce() дальше.
+    bool spinOnce() {
+        long long n = count++;
+        if (n < policy.pauseRounds) {
+            int pauses = n < 30 ? static_cast<int>(std::min<long long>(1LL << n, policy.maxPauses)) : policy.maxPauses;
+            for (int i = 0; i < pauses; ++i) {
+                cpuRelax();
+            }
+            return true;
+        }
+        n -= policy.pauseRounds;
+        if (n < policy.yieldRounds) {
+            std::this_thread::yield();
+            return true;
+        }
+        n -= policy.yieldRounds;
+        if (n < policy.sleepRounds || !policy.park) {
+            if (policy.sleep.count() > 0) {
+                std::this_thread::sleep_for(policy.sleep);
+            } else {
+                std::this_thread::yield();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // Ждать, пока word != value; после исчерпания фаз - atomic::wait.
+    // Писатель обязан вызвать notify_one()/notify_all() после смены значения.
+    template <typename T>
+    T waitWhileEquals(const std::atomic<T>& word, T value,
+                      std::memory_order order = std::memory_order_acquire) {
+        T current;
+        while ((current = word.load(order)) == value) {
+            if (!spinOnce()) {
+                word.wait(value, order);
+            }
+        }
+        return current;
+    }
+
+    void reset() {
+        count = 0;
+    }
+
+    long long spins() const {
+        return count;
+    }
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TreiberStack.h"
+#include "Locks.h"
+#include "CpuUsage.h"
+#include "Tracer.h"
+
+// Стек на std::vector под блокировкой - эталон для TreiberStack
+template <typename T, typename Lock>
+class LockedVectorStack {
+private:
+    std::vector<T> items;
+    Lock lock;
+public:
+    void push(T value) {
+        std::lock_guard<Lock> guard(lock);
+        items.push_back(std::move(value));
+    }
+
+    bool pop(T& out) {
+        std::lock_guard<Lock> guard(lock);
+        if (items.empty()) {
+            return false;
+        }
+        out = std::move(items.back());
+        items.pop_back();
+        return true;
+    }
+
+    size_t capacityBytes() {
+        std::lock_guard<Lock> guard(lock);
+        return items.capacity() * sizeof(T);
+    }
+};
+
+// Гонка push/pop: каждый поток opsPerThread раз кладёт элемент и сразу снимает
+// какой-нибудь. Стек заранее заполнен, чтобы pop почти никогда не был пустым.
+class StackRaceTest {
+private:
+    int numThreads;
+    int opsPerThread;
+    int prefill;
+
+    template <typename Stack>
+    RunEfficiency run(const std::string& name, Stack& stack) {
+        for (int i = 0; i < prefill; ++i) {
+            stack.push(i);
+        }
+        std::vector<std::thread> threads;
+        std::vector<CpuUsage> cpu(numThreads);
+        std::vector<long> empties(numThreads, 0);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int t = 0; t < numThreads; ++t) {
+            threads.emplace_back([&, t]() {
+                CpuUsage cpuStart = CpuUsage::thisThread();
+                RACE_TRACE_PHASE_BEGIN("stack " + name);
+                long value = 0;
+                for (int j = 0; j < opsPerThread; ++j) {
+                    stack.push(j);
+                    if (!stack.pop(value)) {
+                        ++empties[t];
+                    }
+                }
+                RACE_TRACE_PHASE_END("stack " + name);
+                cpu[t] = CpuUsage::thisThread() - cpuStart;
+            });
+        }
+        for (auto& th : threads) {
+            th.join();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+
+        long emptyPops = 0;
+        for (long e : empties) {
+            emptyPops += e;
+        }
+        RunEfficiency efficiency = RunEfficiency::fromThreads(seconds, 2LL * numThreads * opsPerThread, cpu);
+        std::cout << name << " - " << static_cast<long long>(efficiency.throughput()) << " ops/sec"
+                  << (emptyPops ? ", empty pops " + std::to_string(emptyPops) : "") << "\n";
+        efficiency.print();
+        return efficiency;
+    }
+
+public:
+    StackRaceTest(int threads, int ops = 200000, int prefillItems = 1024)
+        : numThreads(threads), opsPerThread(ops), prefill(prefillItems) {}
+
+    void runAllTests() {
+        std::cout << "=== Stack push/pop Tests ===\n";
+        std::cout << "Threads: " << numThreads << ", Push+pop pairs per thread: " << opsPerThread
+                  << ", Prefill: " << prefill << "\n\n";
+
+        {
+            EpochDomain::instance().resetStats();
+            TreiberStack<long> stack;
+            run("Treiber (tagged ptr + EBR)", stack);
+            // Записи потоков уже отданы (потоки завершились), пики сложены
+            EpochDomain& domain = EpochDomain::instance();
+            std::cout << "    reclamation: retired " << domain.retired() << ", freed " << domain.freed()
+                      << ", peak deferred " << domain.peakPending() << " nodes ("
+                      << domain.peakPending() * static_cast<long>(TreiberStack<long>::nodeBytes)
+                      << " bytes, sum of per-thread peaks)\n";
+        }
+        {
+            LockedVectorStack<long, std::mutex> stack;
+            run("std::mutex + vector       ", stack);
+            std::cout << "    vector capacity " << stack.capacityBytes() << " bytes\n";
+        }
+        {
+            // Spinlock из tests/spinlock&spinwait - тот же test_and_set, что TasSpinLock
+            LockedVectorStack<long, TasSpinLock> stack;
+            run("spinlock + vector         ", stack);
+            std::cout << "    vector capacity " << stack.capacityBytes() << " bytes\n";
+        }
+    }
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+#include <utility>
+#include "SeqLock.h"
+
+// Значение под защитой блокировки (обобщение Monitor::safe_update из tests/monitor):
+// к значению нельзя обратиться иначе, чем через withLock/withSharedLock, так что
+// забыть про блокировку невозможно.
+//
+// Для тривиально копируемых T дополнительно ведётся копия в seqlock: snapshot()
+// читает её вообще без блокировки - читатели не пишут в общую память и не мешают
+// друг другу. Писатели уже сериализованы мьютексом, поэтому условие seqlock
+// "один писатель" выполняется.
+template <typename T, typename SharedMutex = std::shared_mutex>
+class Synchronized {
+private:
+    static constexpr bool hasSnapshot = std::is_trivially_copyable_v<T>;
+
+    struct NoMirror {
+        explicit NoMirror(const T&) {}
+    };
+    using Mirror = std::conditional_t<hasSnapshot, SeqLock<T>, NoMirror>;
+
+    T value;
+    mutable SharedMutex mtx;
+    Mirror mirror;
+
+    void publish() {
+        if constexpr (hasSnapshot) {
+            mirror.write(value);
+        }
+    }
+
+public:
+    Synchronized() : value(), mirror(value) {}
+
+    explicit Synchronized(T initial) : value(std::move(initial)), mirror(value) {}
+
+    Synchronized(const Synchronized&) = delete;
+    Synchronized& operator=(const Synchronized&) = delete;
+
+    // Изменение под эксклюзивной блокировкой: fn(T&); результат fn возвращается
+    template <typename F>
+    decltype(auto) withLock(F&& fn) {
+        std::unique_lock<SharedMutex> lock(mtx);
+        if constexpr (std::is_void_v<std::invoke_result_t<F, T&>>) {
+            fn(value);
+            publish();
+        } else {
+            decltype(auto) result = fn(value);
+            publish();
+            return result;
+        }
+    }
+
+    // Чтение под разделяемой блокировкой: fn(const T&)
+    template <typename F>
+    decltype(auto) withSharedLock(F&& fn) const {
+        std::shared_lock<SharedMutex> lock(mtx);
+        return fn(static_cast<const T&>(value));
+    }
+
+    // Согласованная копия без блокировки (только для тривиально копируемых T).
+    // retries - сколько раз чтение попало на запись и было повторено.
+    T snapshot(long long* retries = nullptr) const requires std::is_trivially_copyable_v<T> {
+        return mirror.read(retries);
+    }
+
+    // То же, что safe_update в tests/monitor/monitor.cpp
+    void set(T newValue) {
+        withLock([&newValue](T& v) { v = std::move(newValue); });
+    }
+
+    T get() const {
+        return withSharedLock([](const T& v) { return v; });
+    }
+};
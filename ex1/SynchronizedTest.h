@@ -0,0 +1,135 @@
+#pragma once
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include "Synchronized.h"
+#include "CpuUsage.h"
+#include "Tracer.h"
+
+// Чтение-преобладающая нагрузка на общий объект "конфигурации": на один
+// writer-вызов приходится readsPerWrite чтений. Сравнивается исходный шаблон
+// safe_update (tests/monitor/monitor.cpp, мьютекс на каждое обращение) с
+// Synchronized<T>: чтение под shared_lock и snapshot() через seqlock.
+class SynchronizedReadTest {
+private:
+    // Все поля равны version - по этому ловятся "рваные" чтения
+    struct Config {
+        long long version = 0;
+        long long fields[7] = {};
+    };
+
+    // Monitor из tests/monitor/monitor.cpp, дополненный чтением
+    class SafeUpdateMonitor {
+    private:
+        Config shared_resource;
+        std::mutex mtx;
+    public:
+        void safe_update(const Config& new_value) {
+            std::lock_guard<std::mutex> lock(mtx);
+            shared_resource = new_value;
+        }
+
+        Config read() {
+            std::lock_guard<std::mutex> lock(mtx);
+            return shared_resource;
+        }
+    };
+
+    int numThreads;
+    int opsPerThread;
+    int readsPerWrite;
+
+    static bool consistent(const Config& c) {
+        for (long long f : c.fields) {
+            if (f != c.version) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static Config next(const Config& c) {
+        Config n;
+        n.version = c.version + 1;
+        for (auto& f : n.fields) {
+            f = n.version;
+        }
+        return n;
+    }
+
+    // read() -> Config, write(), по очереди согласно readsPerWrite
+    template <typename Read, typename Write>
+    void run(const std::string& name, Read read, Write write) {
+        std::vector<std::thread> threads;
+        std::vector<CpuUsage> cpu(numThreads);
+        std::atomic<long long> torn{0};
+        std::atomic<long long> checksum{0};
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < numThreads; ++i) {
+            threads.emplace_back([&, i]() {
+                CpuUsage cpuStart = CpuUsage::thisThread();
+                RACE_TRACE_PHASE_BEGIN("read-mostly " + name);
+                long long localTorn = 0;
+                long long sum = 0;
+                for (int j = 0; j < opsPerThread; ++j) {
+                    if ((j + i) % (readsPerWrite + 1) == 0) {
+                        write();
+                    } else {
+                        Config c = read();
+                        localTorn += consistent(c) ? 0 : 1;
+                        sum += c.version;
+                    }
+                }
+                RACE_TRACE_PHASE_END("read-mostly " + name);
+                torn.fetch_add(localTorn, std::memory_order_relaxed);
+                checksum.fetch_add(sum, std::memory_order_relaxed);
+                cpu[i] = CpuUsage::thisThread() - cpuStart;
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+
+        RunEfficiency efficiency = RunEfficiency::fromThreads(seconds, 1LL * numThreads * opsPerThread, cpu);
+        std::cout << name << " - " << static_cast<long long>(efficiency.throughput()) << " ops/sec"
+                  << ", torn reads " << torn.load() << "\n";
+        efficiency.print();
+    }
+
+public:
+    SynchronizedReadTest(int threads, int ops = 200000, int reads = 1000)
+        : numThreads(threads), opsPerThread(ops), readsPerWrite(reads) {}
+
+    void runAllTests() {
+        std::cout << "=== Read-mostly Synchronized<T> Tests ===\n";
+        std::cout << "Threads: " << numThreads << ", Ops per thread: " << opsPerThread
+                  << ", Reads per write: " << readsPerWrite << "\n\n";
+
+        {
+            SafeUpdateMonitor monitor;
+            run("safe_update (std::mutex)      ",
+                [&monitor]() { return monitor.read(); },
+                [&monitor]() { monitor.safe_update(next(monitor.read())); });
+        }
+        {
+            Synchronized<Config> config;
+            run("Synchronized withSharedLock   ",
+                [&config]() { return config.withSharedLock([](const Config& c) { return c; }); },
+                [&config]() { config.withLock([](Config& c) { c = next(c); }); });
+        }
+        {
+            Synchronized<Config> config;
+            run("Synchronized snapshot (seqlock)",
+                [&config]() { return config.snapshot(); },
+                [&config]() { config.withLock([](Config& c) { c = next(c); }); });
+        }
+    }
+};
@@ -0,0 +1,229 @@
+#pragma once
+
+// Потоковая трассировка событий блокировок в формате Chrome trace / Perfetto.
+// Включается только при сборке с -DRACE_TRACE (cmake -DRACE_TRACE=ON);
+// без него макросы RACE_TRACE_* раскрываются в пустоту и ничего не стоят.
+//
+// Каждый поток пишет события в свой кольцевой буфер без блокировок
+// (TSC-метка + указатель на имя + тип), при заполнении старые события
+// перезаписываются. При выходе из программы буферы выгружаются в JSON
+// (файл из RACE_TRACE_FILE, по умолчанию race_trace.json), который открывается
+// в chrome://tracing или ui.perfetto.dev.
+
+#ifdef RACE_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+enum class TraceEventType : std::uint8_t {
+    LockRequest,
+    Acquired,
+    Released,
+    PhaseBegin,
+    PhaseEnd
+};
+
+struct TraceEvent {
+    std::uint64_t tsc;
+    const char* name; // строка должна жить до выгрузки (литерал или имя места захвата)
+    TraceEventType type;
+};
+
+class Tracer {
+private:
+    static constexpr size_t kCapacity = 1 << 15; // событий на поток
+
+    struct ThreadBuffer {
+        int tid;
+        std::unique_ptr<TraceEvent[]> events{new TraceEvent[kCapacity]};
+        std::atomic<size_t> head{0}; // пишет только поток-владелец
+    };
+
+    // Буфер переживает свой поток и отдаётся следующему новому потоку,
+    // поэтому память ограничена числом одновременно живых потоков
+    struct BufferLease {
+        ThreadBuffer* buffer;
+        BufferLease() : buffer(Tracer::instance().acquireBuffer()) {}
+        ~BufferLease() { Tracer::instance().releaseBuffer(buffer); }
+    };
+
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::vector<ThreadBuffer*> freeBuffers;
+    std::deque<std::string> names;
+    std::uint64_t startTsc;
+    std::chrono::steady_clock::time_point startTime;
+
+    Tracer() : startTsc(now()), startTime(std::chrono::steady_clock::now()) {}
+
+    ThreadBuffer* acquireBuffer() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        if (!freeBuffers.empty()) {
+            ThreadBuffer* buffer = freeBuffers.back();
+            freeBuffers.pop_back();
+            return buffer;
+        }
+        buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffers.back()->tid = static_cast<int>(buffers.size());
+        return buffers.back().get();
+    }
+
+    void releaseBuffer(ThreadBuffer* buffer) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        freeBuffers.push_back(buffer);
+    }
+
+    // Тактов TSC в микросекунде - по интервалу от старта до выгрузки
+    double ticksPerMicrosecond() const {
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+        return us > 0 ? (now() - startTsc) / us : 1.0;
+    }
+
+    static void writeEscaped(std::FILE* out, const char* s) {
+        for (; *s; ++s) {
+            if (*s == '"' || *s == '\\') {
+                std::fputc('\\', out);
+            }
+            std::fputc(*s, out);
+        }
+    }
+
+public:
+    // Объект намеренно не разрушается: выгрузка идёт из atexit,
+    // уже после деструкторов статических объектов
+    static Tracer& instance() {
+        static Tracer* tracer = [] {
+            Tracer* t = new Tracer();
+            std::atexit([] { Tracer::instance().dump(); });
+            return t;
+        }();
+        return *tracer;
+    }
+
+    // Постоянная копия имени фазы (имена событий должны жить до выгрузки)
+    const char* intern(const std::string& name) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const auto& n : names) {
+            if (n == name) {
+                return n.c_str();
+            }
+        }
+        return names.emplace_back(name).c_str();
+    }
+
+    static std::uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    void record(TraceEventType type, const char* name) {
+        static thread_local BufferLease lease;
+        ThreadBuffer* buffer = lease.buffer;
+        size_t h = buffer->head.load(std::memory_order_relaxed);
+        buffer->events[h % kCapacity] = TraceEvent{now(), name, type};
+        buffer->head.store(h + 1, std::memory_order_release);
+    }
+
+    void dump() {
+        const char* path = std::getenv("RACE_TRACE_FILE");
+        if (!path) {
+            path = "race_trace.json";
+        }
+        std::FILE* out = std::fopen(path, "w");
+        if (!out) {
+            return;
+        }
+
+        double ticksPerUs = ticksPerMicrosecond();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        std::fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+        bool first = true;
+        size_t total = 0;
+        for (const auto& buffer : buffers) {
+            auto emit = [&](const char* ph, const char* prefix, const TraceEvent& e) {
+                std::fprintf(out, "%s{\"name\":\"%s", first ? "" : ",\n", prefix);
+                writeEscaped(out, e.name);
+                std::fprintf(out, "\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}",
+                             ph, (e.tsc - startTsc) / ticksPerUs, buffer->tid);
+                first = false;
+                ++total;
+            };
+
+            // Ожидание - от LockRequest до Acquired, удержание - от Acquired до Released.
+            // Концы интервалов, начала которых затёрты в кольце, отбрасываются.
+            size_t head = buffer->head.load(std::memory_order_acquire);
+            size_t begin = head > kCapacity ? head - kCapacity : 0;
+            bool waiting = false;
+            int holds = 0;
+            int phases = 0;
+            for (size_t n = begin; n < head; ++n) {
+                const TraceEvent& e = buffer->events[n % kCapacity];
+                switch (e.type) {
+                    case TraceEventType::LockRequest:
+                        emit("B", "wait ", e);
+                        waiting = true;
+                        break;
+                    case TraceEventType::Acquired:
+                        if (waiting) {
+                            emit("E", "wait ", e);
+                            waiting = false;
+                        }
+                        emit("B", "hold ", e);
+                        ++holds;
+                        break;
+                    case TraceEventType::Released:
+                        if (holds > 0) {
+                            emit("E", "hold ", e);
+                            --holds;
+                        }
+                        break;
+                    case TraceEventType::PhaseBegin:
+                        emit("B", "", e);
+                        ++phases;
+                        break;
+                    case TraceEventType::PhaseEnd:
+                        if (phases > 0) {
+                            emit("E", "", e);
+                            --phases;
+                        }
+                        break;
+                }
+            }
+        }
+        std::fprintf(out, "\n]}\n");
+        std::fclose(out);
+        std::fprintf(stderr, "Trace: %zu events from %zu threads written to %s\n", total, buffers.size(), path);
+    }
+};
+
+#define RACE_TRACE_LOCK_REQUEST(name) Tracer::instance().record(TraceEventType::LockRequest, (name))
+#define RACE_TRACE_ACQUIRED(name) Tracer::instance().record(TraceEventType::Acquired, (name))
+#define RACE_TRACE_RELEASED(name) Tracer::instance().record(TraceEventType::Released, (name))
+#define RACE_TRACE_PHASE_BEGIN(name) Tracer::instance().record(TraceEventType::PhaseBegin, Tracer::instance().intern(name))
+#define RACE_TRACE_PHASE_END(name) Tracer::instance().record(TraceEventType::PhaseEnd, Tracer::instance().intern(name))
+
+#else
+
+#define RACE_TRACE_LOCK_REQUEST(name) ((void)0)
+#define RACE_TRACE_ACQUIRED(name) ((void)0)
+#define RACE_TRACE_RELEASED(name) ((void)0)
+#define RACE_TRACE_PHASE_BEGIN(name) ((void)0)
+#define RACE_TRACE_PHASE_END(name) ((void)0)
+
+#endif
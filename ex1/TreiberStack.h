@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include "EpochReclamation.h"
+
+// Lock-free стек Трайбера.
+// Вершина - 64-битное слово: 48 бит указателя и 16 бит счётчика версий, который
+// растёт при каждом успешном CAS. Так CAS не спутает старую вершину с той же,
+// вернувшейся после pop/push (ABA), и хватает обычного 64-битного CAS вместо
+// cmpxchg16b. Снятые узлы освобождаются через EpochDomain: pop читает
+// top->next, и узел не должен исчезнуть, пока кто-то ещё может его читать.
+template <typename T>
+class TreiberStack {
+    static_assert(sizeof(void*) == 8, "tagged pointers need a 64-bit address space");
+
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+
+    static constexpr std::uint64_t kPointerMask = (std::uint64_t{1} << 48) - 1;
+
+    static Node* pointer(std::uint64_t word) {
+        return reinterpret_cast<Node*>(word & kPointerMask);
+    }
+
+    static std::uint64_t pack(Node* node, std::uint64_t previous) {
+        std::uint64_t tag = (previous >> 48) + 1;
+        return (tag << 48) | (reinterpret_cast<std::uint64_t>(node) & kPointerMask);
+    }
+
+    alignas(64) std::atomic<std::uint64_t> head{0};
+
+public:
+    static constexpr size_t nodeBytes = sizeof(Node);
+
+    TreiberStack() = default;
+    TreiberStack(const TreiberStack&) = delete;
+    TreiberStack& operator=(const TreiberStack&) = delete;
+
+    // Вызывать, когда стеком больше никто не пользуется
+    ~TreiberStack() {
+        Node* node = pointer(head.load(std::memory_order_relaxed));
+        while (node) {
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    void push(T value) {
+        Node* node = new Node{std::move(value), nullptr};
+        std::uint64_t old = head.load(std::memory_order_relaxed);
+        do {
+            node->next = pointer(old);
+        } while (!head.compare_exchange_weak(old, pack(node, old),
+                 std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    bool pop(T& out) {
+        EpochGuard guard;
+        std::uint64_t old = head.load(std::memory_order_acquire);
+        while (Node* node = pointer(old)) {
+            if (head.compare_exchange_weak(old, pack(node->next, old),
+                    std::memory_order_acquire, std::memory_order_acquire)) {
+                out = std::move(node->value);
+                EpochDomain::instance().retire(node);
+                return true;
+            }
+        }
+        return false;
+    }
+};
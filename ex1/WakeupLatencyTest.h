@@ -0,0 +1,327 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <semaphore>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "SpinWait.h"
+
+// Задержка пробуждения "поток -> поток": два потока перебрасываются сигналом
+// (пинг-понг, как main/worker с двумя binary_semaphore в tests/semaphore),
+// измеряется время полного круга. Это нижняя граница для передачи запроса
+// между потоками через данный примитив.
+//
+// Сигнал - односторонний объект с post()/wait(); в пинг-понге их два.
+namespace wakeup {
+
+class SemaphoreSignal {
+private:
+    std::binary_semaphore sem{0};
+public:
+    void post() { sem.release(); }
+    void wait() { sem.acquire(); }
+};
+
+class CondVarSignal {
+private:
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool ready = false;
+public:
+    void post() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            ready = true;
+        }
+        cv.notify_one();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this]() { return ready; });
+        ready = false;
+    }
+};
+
+// Голый futex: каждый post() - системный вызов FUTEX_WAKE
+class FutexSignal {
+private:
+    std::atomic<int> word{0};
+
+    long futex(int op, int value) {
+        return syscall(SYS_futex, reinterpret_cast<int*>(&word), op, value, nullptr, nullptr, 0);
+    }
+public:
+    void post() {
+        word.store(1, std::memory_order_release);
+        futex(FUTEX_WAKE_PRIVATE, 1);
+    }
+
+    void wait() {
+        while (word.exchange(0, std::memory_order_acquire) == 0) {
+            futex(FUTEX_WAIT_PRIVATE, 0);
+        }
+    }
+};
+
+class AtomicWaitSignal {
+private:
+    std::atomic<int> word{0};
+public:
+    void post() {
+        word.store(1, std::memory_order_release);
+        word.notify_one();
+    }
+
+    void wait() {
+        while (word.exchange(0, std::memory_order_acquire) == 0) {
+            word.wait(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+class EventfdSignal {
+private:
+    int fd;
+public:
+    EventfdSignal() : fd(eventfd(0, 0)) {
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "eventfd");
+        }
+    }
+
+    ~EventfdSignal() {
+        close(fd);
+    }
+
+    EventfdSignal(const EventfdSignal&) = delete;
+    EventfdSignal& operator=(const EventfdSignal&) = delete;
+
+    void post() {
+        std::uint64_t one = 1;
+        while (write(fd, &one, sizeof(one)) < 0 && errno == EINTR) {
+        }
+    }
+
+    void wait() {
+        std::uint64_t value;
+        while (read(fd, &value, sizeof(value)) < 0 && errno == EINTR) {
+        }
+    }
+};
+
+class PipeSignal {
+private:
+    int fds[2];
+public:
+    PipeSignal() {
+        if (pipe(fds) != 0) {
+            throw std::system_error(errno, std::generic_category(), "pipe");
+        }
+    }
+
+    ~PipeSignal() {
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    PipeSignal(const PipeSignal&) = delete;
+    PipeSignal& operator=(const PipeSignal&) = delete;
+
+    void post() {
+        char byte = 1;
+        while (write(fds[1], &byte, 1) < 0 && errno == EINTR) {
+        }
+    }
+
+    void wait() {
+        char byte;
+        while (read(fds[0], &byte, 1) < 0 && errno == EINTR) {
+        }
+    }
+};
+
+// Чистый спин без ядра: нижняя граница, но только если потоки на разных ядрах
+class SpinSignal {
+private:
+    alignas(64) std::atomic<int> word{0};
+public:
+    void post() {
+        word.store(1, std::memory_order_release);
+    }
+
+    void wait() {
+        SpinWait spin(SpinPolicy::spinOnly());
+        while (word.exchange(0, std::memory_order_acquire) == 0) {
+            spin.spinOnce();
+        }
+    }
+};
+
+} // namespace wakeup
+
+class WakeupLatencyTest {
+private:
+    // Пара процессоров для пинг-понга; -1 - без привязки
+    struct Placement {
+        std::string name;
+        int cpuA = -1;
+        int cpuB = -1;
+    };
+
+    int roundTrips;
+    int warmup;
+
+    static void pinTo(int cpu) {
+        if (cpu < 0) {
+            return;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+    static int readTopology(int cpu, const char* field) {
+        std::ifstream in("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/" + field);
+        int value = -1;
+        in >> value;
+        return value;
+    }
+
+    static long long percentile(const std::vector<long long>& sorted, double p) {
+        if (sorted.empty()) {
+            return 0;
+        }
+        return sorted[static_cast<size_t>(p * (sorted.size() - 1))];
+    }
+
+    // Доступные процессоры из маски потока и их ядра по sysfs
+    static std::vector<Placement> detectPlacements() {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        sched_getaffinity(0, sizeof(allowed), &allowed);
+        std::vector<int> cpus;
+        for (int c = 0; c < CPU_SETSIZE; ++c) {
+            if (CPU_ISSET(c, &allowed)) {
+                cpus.push_back(c);
+            }
+        }
+
+        std::vector<Placement> result;
+        if (cpus.empty()) {
+            return result;
+        }
+        result.push_back({"same core (cpu " + std::to_string(cpus[0]) + ")", cpus[0], cpus[0]});
+
+        auto coreOf = [](int cpu) {
+            return std::make_pair(readTopology(cpu, "physical_package_id"), readTopology(cpu, "core_id"));
+        };
+        bool smt = false;
+        bool cross = false;
+        for (size_t b = 1; b < cpus.size() && !(smt && cross); ++b) {
+            bool sibling = coreOf(cpus[0]) == coreOf(cpus[b]) && coreOf(cpus[0]).second >= 0;
+            std::string pair = " (cpu " + std::to_string(cpus[0]) + " <-> " + std::to_string(cpus[b]) + ")";
+            if (sibling && !smt) {
+                result.push_back({"SMT sibling" + pair, cpus[0], cpus[b]});
+                smt = true;
+            } else if (!sibling && !cross) {
+                result.push_back({"cross core" + pair, cpus[0], cpus[b]});
+                cross = true;
+            }
+        }
+        if (!smt) {
+            std::cout << "(no SMT sibling available - SMT placement skipped)\n";
+        }
+        if (!cross) {
+            std::cout << "(only one core available - cross-core placement skipped)\n";
+        }
+        return result;
+    }
+
+    // Один пинг-понг: A шлёт ping и ждёт pong, B отвечает
+    template <typename Signal>
+    void run(const std::string& name, const Placement& placement) {
+        Signal ping;
+        Signal pong;
+        std::vector<long long> rtt;
+        rtt.reserve(roundTrips);
+        int total = warmup + roundTrips;
+
+        std::thread responder([&]() {
+            pinTo(placement.cpuB);
+            for (int n = 0; n < total; ++n) {
+                ping.wait();
+                pong.post();
+            }
+        });
+        std::thread initiator([&]() {
+            pinTo(placement.cpuA);
+            for (int n = 0; n < total; ++n) {
+                auto t0 = std::chrono::steady_clock::now();
+                ping.post();
+                pong.wait();
+                auto t1 = std::chrono::steady_clock::now();
+                if (n >= warmup) {
+                    rtt.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+                }
+            }
+        });
+        initiator.join();
+        responder.join();
+
+        std::sort(rtt.begin(), rtt.end());
+        std::cout << "    " << std::left << std::setw(16) << name << std::right
+                  << std::setw(10) << percentile(rtt, 0.50)
+                  << std::setw(10) << percentile(rtt, 0.90)
+                  << std::setw(10) << percentile(rtt, 0.99)
+                  << std::setw(10) << percentile(rtt, 0.999)
+                  << std::setw(12) << (rtt.empty() ? 0 : rtt.back()) << "\n";
+    }
+
+public:
+    explicit WakeupLatencyTest(int trips = 20000, int warmupTrips = 1000)
+        : roundTrips(trips), warmup(warmupTrips) {}
+
+    void runAllTests() {
+        std::cout << "=== Wakeup Latency (ping-pong round trip, ns) ===\n";
+        std::cout << "Round trips: " << roundTrips << " (+" << warmup << " warm-up)\n";
+
+        for (const auto& placement : detectPlacements()) {
+            std::cout << "\n" << placement.name << ":\n";
+            std::cout << "    " << std::left << std::setw(16) << "primitive" << std::right
+                      << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99"
+                      << std::setw(10) << "p99.9" << std::setw(12) << "max" << "\n";
+            run<wakeup::SemaphoreSignal>("binary_semaphore", placement);
+            run<wakeup::CondVarSignal>("condvar", placement);
+            run<wakeup::FutexSignal>("futex", placement);
+            run<wakeup::AtomicWaitSignal>("atomic::wait", placement);
+            run<wakeup::EventfdSignal>("eventfd", placement);
+            run<wakeup::PipeSignal>("pipe", placement);
+            if (placement.cpuA != placement.cpuB) {
+                run<wakeup::SpinSignal>("spin", placement);
+            } else {
+                std::cout << "    spin            skipped: on one core it only measures the scheduler quantum\n";
+            }
+        }
+    }
+};
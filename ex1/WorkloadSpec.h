@@ -0,0 +1,308 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Распределение длительности в наносекундах.
+// Текстовая форма: "500ns" или "fixed:500ns", "exp:2us" (среднее),
+// "bimodal:1us,50us,0.1" (короткая, длинная, доля длинных); "0" - нет времени.
+struct Distribution {
+    enum class Kind { Fixed, Exponential, Bimodal };
+
+    Kind kind = Kind::Fixed;
+    long long ns = 0;        // Fixed - значение, Exponential - среднее, Bimodal - короткая мода
+    long long longNs = 0;    // Bimodal - длинная мода
+    double longFraction = 0; // Bimodal - вероятность длинной моды
+
+    static Distribution fixed(long long ns) {
+        return Distribution{Kind::Fixed, ns};
+    }
+
+    static Distribution exponential(long long meanNs) {
+        return Distribution{Kind::Exponential, meanNs};
+    }
+
+    static Distribution bimodal(long long shortNs, long long longNs, double longFraction) {
+        return Distribution{Kind::Bimodal, shortNs, longNs, longFraction};
+    }
+
+    template <typename Rng>
+    long long sample(Rng& rng) const {
+        switch (kind) {
+        case Kind::Exponential:
+            return ns > 0 ? static_cast<long long>(std::exponential_distribution<double>(1.0 / ns)(rng)) : 0;
+        case Kind::Bimodal:
+            return std::bernoulli_distribution(longFraction)(rng) ? longNs : ns;
+        default:
+            return ns;
+        }
+    }
+
+    double mean() const {
+        if (kind == Kind::Bimodal) {
+            return ns + longFraction * (longNs - ns);
+        }
+        return static_cast<double>(ns);
+    }
+
+    bool empty() const {
+        return ns == 0 && (kind != Kind::Bimodal || longNs == 0 || longFraction == 0);
+    }
+
+    // "250", "250ns", "2us", "1.5ms", "1s" -> наносекунды (без суффикса - наносекунды)
+    static long long parseDuration(const std::string& text) {
+        size_t used = 0;
+        double value = 0;
+        try {
+            value = std::stod(text, &used);
+        } catch (const std::exception&) {
+            throw std::invalid_argument("bad duration \"" + text + "\"");
+        }
+        std::string unit = text.substr(used);
+        double scale = 1;
+        if (unit == "us") {
+            scale = 1e3;
+        } else if (unit == "ms") {
+            scale = 1e6;
+        } else if (unit == "s") {
+            scale = 1e9;
+        } else if (!unit.empty() && unit != "ns") {
+            throw std::invalid_argument("bad duration unit \"" + text + "\"");
+        }
+        if (value < 0) {
+            throw std::invalid_argument("negative duration \"" + text + "\"");
+        }
+        return static_cast<long long>(value * scale);
+    }
+
+    static Distribution parse(const std::string& spec) {
+        // В записи распределения пробелы незначимы: "bimodal:1us, 50us, 0.1"
+        std::string text = spec;
+        text.erase(std::remove_if(text.begin(), text.end(),
+                                  [](unsigned char c) { return std::isspace(c); }), text.end());
+        size_t colon = text.find(':');
+        if (colon == std::string::npos) {
+            return fixed(parseDuration(text));
+        }
+        std::string kind = text.substr(0, colon);
+        std::string args = text.substr(colon + 1);
+        if (kind == "fixed") {
+            return fixed(parseDuration(args));
+        }
+        if (kind == "exp") {
+            return exponential(parseDuration(args));
+        }
+        if (kind == "bimodal") {
+            size_t first = args.find(',');
+            size_t second = first == std::string::npos ? first : args.find(',', first + 1);
+            if (second == std::string::npos) {
+                throw std::invalid_argument("bimodal needs short,long,fraction: \"" + text + "\"");
+            }
+            double fraction = std::stod(args.substr(second + 1));
+            if (fraction < 0 || fraction > 1) {
+                throw std::invalid_argument("bimodal fraction out of [0, 1]: \"" + text + "\"");
+            }
+            return bimodal(parseDuration(args.substr(0, first)),
+                           parseDuration(args.substr(first + 1, second - first - 1)), fraction);
+        }
+        throw std::invalid_argument("unknown distribution \"" + kind + "\"");
+    }
+
+    std::string describe() const {
+        auto fmt = [](long long v) {
+            if (v >= 1000000 && v % 1000000 == 0) return std::to_string(v / 1000000) + "ms";
+            if (v >= 1000 && v % 1000 == 0) return std::to_string(v / 1000) + "us";
+            return std::to_string(v) + "ns";
+        };
+        switch (kind) {
+        case Kind::Exponential:
+            return "exp:" + fmt(ns);
+        case Kind::Bimodal: {
+            std::ostringstream out;
+            out << "bimodal:" << fmt(ns) << "," << fmt(longNs) << "," << longFraction;
+            return out.str();
+        }
+        default:
+            return "fixed:" + fmt(ns);
+        }
+    }
+};
+
+// Декларативное описание нагрузки на блокировку - профиль конкуренции, который
+// можно воспроизвести в ThreadRaceTest, test.cpp и бенчмарках.
+//
+// Формат - строки key=value (в командной строке можно через ';'), '#' - комментарий:
+//   name=checkout          # имя в отчётах
+//   hold=exp:2us           # время в критической секции
+//   think=bimodal:1us,200us,0.05  # время между захватами, вне блокировки
+//   shared=0.3             # вероятность, что захват идёт на общую блокировку,
+//                          # иначе - на собственную блокировку потока
+//   hold_scale=1,1,1,8     # множители по потокам (поток i берёт элемент i % размер):
+//   think_scale=1,4        # неоднородность потоков
+//   threads=16             # необязательно: число потоков и захватов на поток
+//   length=2000
+struct WorkloadSpec {
+    std::string name = "workload";
+    Distribution hold = Distribution::fixed(10000);
+    Distribution think;
+    double sharedProbability = 1.0;
+    std::vector<double> holdScale;
+    std::vector<double> thinkScale;
+    int threads = 0; // 0 - берётся из командной строки
+    int length = 0;
+
+    double holdScaleFor(int thread) const {
+        return holdScale.empty() ? 1.0 : holdScale[thread % holdScale.size()];
+    }
+
+    double thinkScaleFor(int thread) const {
+        return thinkScale.empty() ? 1.0 : thinkScale[thread % thinkScale.size()];
+    }
+
+    template <typename Rng>
+    long long sampleHold(int thread, Rng& rng) const {
+        return static_cast<long long>(hold.sample(rng) * holdScaleFor(thread));
+    }
+
+    template <typename Rng>
+    long long sampleThink(int thread, Rng& rng) const {
+        return static_cast<long long>(think.sample(rng) * thinkScaleFor(thread));
+    }
+
+    template <typename Rng>
+    bool pickShared(Rng& rng) const {
+        return sharedProbability >= 1.0 || std::bernoulli_distribution(sharedProbability)(rng);
+    }
+
+    static WorkloadSpec parse(const std::string& text) {
+        WorkloadSpec spec;
+        std::string normalized = text;
+        std::replace(normalized.begin(), normalized.end(), ';', '\n');
+        std::istringstream lines(normalized);
+        std::string line;
+        while (std::getline(lines, line)) {
+            line = trim(line.substr(0, line.find('#')));
+            if (line.empty()) {
+                continue;
+            }
+            size_t eq = line.find('=');
+            if (eq == std::string::npos) {
+                throw std::invalid_argument("workload line without '=': \"" + line + "\"");
+            }
+            spec.set(trim(line.substr(0, eq)), trim(line.substr(eq + 1)));
+        }
+        return spec;
+    }
+
+    static WorkloadSpec fromFile(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) {
+            throw std::runtime_error("cannot open workload file " + path);
+        }
+        std::ostringstream text;
+        text << in.rdbuf();
+        WorkloadSpec spec = parse(text.str());
+        if (spec.name == "workload") {
+            spec.name = path.substr(path.find_last_of('/') + 1);
+        }
+        return spec;
+    }
+
+    // Аргумент командной строки: встроенное описание, если есть '=', иначе путь к файлу
+    static WorkloadSpec load(const std::string& fileOrSpec) {
+        return fileOrSpec.find('=') != std::string::npos ? parse(fileOrSpec) : fromFile(fileOrSpec);
+    }
+
+    std::string describe() const {
+        std::ostringstream out;
+        out << name << ": hold " << hold.describe() << ", think " << think.describe()
+            << ", shared " << sharedProbability;
+        auto list = [&out](const char* key, const std::vector<double>& values) {
+            if (values.empty()) {
+                return;
+            }
+            out << ", " << key << " ";
+            for (size_t k = 0; k < values.size(); ++k) {
+                out << (k ? "," : "") << values[k];
+            }
+        };
+        list("hold_scale", holdScale);
+        list("think_scale", thinkScale);
+        return out.str();
+    }
+
+private:
+    // Пробелы внутри значения сохраняются ("name=my checkout")
+    static std::string trim(const std::string& text) {
+        auto isSpace = [](unsigned char c) { return std::isspace(c) != 0; };
+        auto first = std::find_if_not(text.begin(), text.end(), isSpace);
+        auto last = std::find_if_not(text.rbegin(), text.rend(), isSpace).base();
+        return first < last ? std::string(first, last) : std::string();
+    }
+
+    static std::vector<double> parseList(const std::string& text) {
+        std::vector<double> values;
+        std::istringstream items(text);
+        std::string item;
+        while (std::getline(items, item, ',')) {
+            double v = std::stod(item);
+            if (v < 0) {
+                throw std::invalid_argument("negative scale \"" + item + "\"");
+            }
+            values.push_back(v);
+        }
+        return values;
+    }
+
+    void set(const std::string& key, const std::string& value) {
+        if (key == "name") {
+            name = value;
+        } else if (key == "hold") {
+            hold = Distribution::parse(value);
+        } else if (key == "think") {
+            think = Distribution::parse(value);
+        } else if (key == "shared") {
+            sharedProbability = std::stod(value);
+            if (sharedProbability < 0 || sharedProbability > 1) {
+                throw std::invalid_argument("shared probability out of [0, 1]: " + value);
+            }
+        } else if (key == "hold_scale") {
+            holdScale = parseList(value);
+        } else if (key == "think_scale") {
+            thinkScale = parseList(value);
+        } else if (key == "threads") {
+            threads = std::stoi(value);
+        } else if (key == "length") {
+            length = std::stoi(value);
+        } else {
+            throw std::invalid_argument("unknown workload key \"" + key + "\"");
+        }
+    }
+};
+
+// Провести ns наносекунд "в работе": короткие интервалы - активным ожиданием
+// (sleep_for спит не меньше десятков мкс), длинные - сном.
+// Возвращает фактически прошедшее время - сон обычно перебирает.
+inline long long spendWorkloadTime(long long ns, long long spinBelowNs = 50000) {
+    if (ns <= 0) {
+        return 0;
+    }
+    auto start = std::chrono::steady_clock::now();
+    if (ns >= spinBelowNs) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(ns));
+    } else {
+        auto until = start + std::chrono::nanoseconds(ns);
+        while (std::chrono::steady_clock::now() < until) {
+            // Busy work
+        }
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
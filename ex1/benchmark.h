@@ -1,7 +1,9 @@
 #pragma once
 
 #include <benchmark/benchmark.h> 
+#include <cstdlib>
 #include "RaceTest.h"
+#include "WorkloadSpec.h"
 
 class SynchronizationBenchmark {
 public:
@@ -19,12 +21,48 @@ public:
         }
     }
     
+    static void BM_FastSemaphore(benchmark::State& state) {
+        ThreadRaceTest test(state.range(0), state.range(1));
+        for (auto _ : state) {
+            test.testWithFastSemaphore();
+        }
+    }
+    
     static void BM_SpinLock(benchmark::State& state) {
         ThreadRaceTest test(state.range(0), state.range(1));
         for (auto _ : state) {
             test.testWithSpinLock();
         }
     }
+    
+    static void BM_SpinWait(benchmark::State& state) {
+        ThreadRaceTest test(state.range(0), state.range(1));
+        for (auto _ : state) {
+            test.testWithSpinWait();
+        }
+    }
+    
+    // Сочетания RMW/порядка памяти из SpinPrimitives.h, пустая критическая секция
+    template <typename Lock>
+    static void BM_SpinOrdering(benchmark::State& state) {
+        ThreadRaceTest test(state.range(0), state.range(1));
+        test.setHoldTime(0);
+        for (auto _ : state) {
+            Lock lock;
+            test.runLockRace(Lock::name(), lock);
+        }
+    }
+    
+    // Профиль нагрузки из RACE_WORKLOAD (файл или строка key=value;...)
+    template <typename Lock>
+    static void BM_Workload(benchmark::State& state, const WorkloadSpec& spec, const std::string& name) {
+        ThreadRaceTest test(state.range(0), state.range(1));
+        test.setWorkload(spec);
+        for (auto _ : state) {
+            Lock lock;
+            test.runLockRace(name, lock);
+        }
+    }
 };
 
 // Регистрация бенчмарков
@@ -38,7 +76,56 @@ BENCHMARK(SynchronizationBenchmark::BM_Semaphore)
     ->Args({8, 100})
     ->Args({16, 100});
 
+BENCHMARK(SynchronizationBenchmark::BM_FastSemaphore)
+    ->Args({4, 100})
+    ->Args({8, 100})
+    ->Args({16, 100});
+
 BENCHMARK(SynchronizationBenchmark::BM_SpinLock)
     ->Args({4, 100})
     ->Args({8, 100})
     ->Args({16, 100});
+
+BENCHMARK(SynchronizationBenchmark::BM_SpinWait)
+    ->Args({4, 100})
+    ->Args({8, 100})
+    ->Args({16, 100});
+
+// Все 24 сочетания SpinPrimitives.h регистрируются программно
+inline const int spinOrderingRegistered = [] {
+    forEachSpinOrdering([]<typename Lock>() {
+        benchmark::RegisterBenchmark(("BM_SpinOrdering/" + Lock::name()).c_str(),
+                                     &SynchronizationBenchmark::BM_SpinOrdering<Lock>)
+            ->Args({4, 1000})
+            ->Args({8, 1000})
+            ->Args({16, 1000});
+    });
+    return 0;
+}();
+
+// Профиль нагрузки регистрируется только при заданном RACE_WORKLOAD,
+// по одному бенчмарку на примитив из forEachLockPrimitive
+inline const int workloadRegistered = [] {
+    const char* source = std::getenv("RACE_WORKLOAD");
+    if (source == nullptr) {
+        return 0;
+    }
+    // Ещё до main: ошибка в описании не должна ронять остальные режимы
+    static WorkloadSpec spec;
+    try {
+        spec = WorkloadSpec::load(source);
+    } catch (const std::exception& e) {
+        std::cerr << "RACE_WORKLOAD ignored: " << e.what() << "\n";
+        return 0;
+    }
+    forEachLockPrimitive([]<typename Lock>(const std::string& name) {
+        auto* bm = benchmark::RegisterBenchmark(("BM_Workload/" + spec.name + "/" + name).c_str(),
+                                                &SynchronizationBenchmark::BM_Workload<Lock>, spec, name);
+        if (spec.threads > 0) {
+            bm->Args({spec.threads, spec.length > 0 ? spec.length : 1000});
+        } else {
+            bm->Args({4, 1000})->Args({8, 1000})->Args({16, 1000});
+        }
+    });
+    return 0;
+}();
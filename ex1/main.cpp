@@ -1,7 +1,230 @@
 #include "benchmark.h"
 #include "RaceTest.h"
+#include "ProducerConsumerTest.h"
+#include "SynchronizedTest.h"
+#include "WakeupLatencyTest.h"
+#include "JacobiTest.h"
+#include "CounterTest.h"
+#include "StackTest.h"
+#include "AllocationTest.h"
+#include "ProcessSharedTest.h"
+#include "ScalabilityFit.h"
+#include "WorkloadSpec.h"
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
 
-int main() {
+int main(int argc, char** argv) {
+    // Профилировщик блокировок: LOCK_PROFILE=<период выборки>, например LOCK_PROFILE=16
+    // (0 или не число - профилировщик выключен)
+    if (const char* profile = std::getenv("LOCK_PROFILE"); profile && std::atoi(profile) > 0) {
+        LockProfiler::instance().enable(true, std::atoi(profile));
+    }
+    
+    std::string mode = argc > 1 ? argv[1] : "";
+    
+    // Производители/потребители: thread_race pc [producers] [consumers] [items per producer]
+    if (mode == "pc") {
+        int producers = argc > 2 ? std::atoi(argv[2]) : 4;
+        int consumers = argc > 3 ? std::atoi(argv[3]) : 4;
+        int items = argc > 4 ? std::atoi(argv[4]) : 100000;
+        if (producers < 1 || consumers < 1 || items < 0) {
+            std::cerr << "pc: need at least one producer and one consumer, items >= 0\n";
+            return 1;
+        }
+        ProducerConsumerTest test(producers, consumers, items);
+        test.runAllTests();
+        return 0;
+    }
+    
+    // Матрица порядков памяти spin-блокировок: thread_race ordering [threads] [length] [hold us]
+    if (mode == "ordering") {
+        int threads = argc > 2 ? std::atoi(argv[2]) : 4;
+        int length = argc > 3 ? std::atoi(argv[3]) : 100000;
+        ThreadRaceTest test(threads, length);
+        test.setHoldTime(argc > 4 ? std::atoi(argv[4]) : 0);
+        test.testSpinOrderingMatrix();
+        return 0;
+    }
+    
+    // Развёртка числа полос блокировок: thread_race stripes [threads] [length]
+    if (mode == "stripes") {
+        int threads = argc > 2 ? std::atoi(argv[2]) : 8;
+        int length = argc > 3 ? std::atoi(argv[3]) : 200;
+        ThreadRaceTest test(threads, length);
+        test.testStripedGranularity();
+        return 0;
+    }
+    
+    // Гонка с живым наблюдателем: thread_race observe [threads] [length] [hz]
+    if (mode == "observe") {
+        int threads = argc > 2 ? std::atoi(argv[2]) : 8;
+        int length = argc > 3 ? std::atoi(argv[3]) : 500;
+        ThreadRaceTest test(threads, length);
+        test.enableObserver(argc > 4 ? std::atoi(argv[4]) : 30);
+        test.runAllTests();
+        return 0;
+    }
+    
+    // Смещённая блокировка при перекосе: thread_race biased [threads] [length]
+    if (mode == "biased") {
+        int threads = argc > 2 ? std::atoi(argv[2]) : 4;
+        int length = argc > 3 ? std::atoi(argv[3]) : 100000;
+        ThreadRaceTest test(threads, length);
+        test.setHoldTime(0);
+        for (int percent : {50, 90, 99, 100}) {
+            test.testBiasedSkew(percent);
+        }
+        return 0;
+    }
+    
+    // Пакетная запись под одним захватом: thread_race batch [threads] [length] [hold us]
+    if (mode == "batch") {
+        int threads = argc > 2 ? std::atoi(argv[2]) : 4;
+        int length = argc > 3 ? std::atoi(argv[3]) : 20000;
+        ThreadRaceTest test(threads, length);
+        test.setHoldTime(argc > 4 ? std::atoi(argv[4]) : 0);
+        test.testBatchingSweep();
+        return 0;
+    }
+    
+    // Открытый цикл, развёртка частоты до насыщения:
+    // thread_race openloop [threads] [hold us] [poisson|fixed] [start rate]
+    if (mode == "openloop") {
+        int threads = argc > 2 ? std::atoi(argv[2]) : 4;
+        ThreadRaceTest test(threads);
+        test.setHoldTime(argc > 3 ? std::atoi(argv[3]) : 10);
+        bool poisson = argc > 4 ? std::string(argv[4]) != "fixed" : true;
+        double startRate = argc > 5 ? std::atof(argv[5]) : 1000;
+        test.testOpenLoopSweep(startRate, 0.25, poisson);
+        return 0;
+    }
+    
+    // Адаптивная блокировка на сетке потоки x длина секции: thread_race adaptive [max threads] [length]
+    if (mode == "adaptive") {
+        int threads = argc > 2 ? std::atoi(argv[2]) : 16;
+        int length = argc > 3 ? std::atoi(argv[3]) : 500;
+        ThreadRaceTest test(threads, length);
+        test.testAdaptiveGrid();
+        return 0;
+    }
+    
+    // Нативные мьютексы glibc: thread_race pthread [max threads] [length] [hold us] [busy ns]
+    if (mode == "pthread") {
+        int threads = argc > 2 ? std::atoi(argv[2]) : 16;
+        int length = argc > 3 ? std::atoi(argv[3]) : 20000;
+        ThreadRaceTest test(threads, length);
+        test.setHoldTime(argc > 4 ? std::atoi(argv[4]) : 0);
+        test.setHoldWork(argc > 5 ? std::atoi(argv[5]) : 0);
+        test.testPthreadBackends();
+        return 0;
+    }
+    
+    // SpinWait против самодельных циклов: thread_race spinwait [max threads] [length] [hold us] [busy ns]
+    if (mode == "spinwait") {
+        int threads = argc > 2 ? std::atoi(argv[2]) : 16;
+        int length = argc > 3 ? std::atoi(argv[3]) : 20000;
+        ThreadRaceTest test(threads, length);
+        test.setHoldTime(argc > 4 ? std::atoi(argv[4]) : 0);
+        test.setHoldWork(argc > 5 ? std::atoi(argv[5]) : 0);
+        test.testSpinWaitPolicies();
+        return 0;
+    }
+    
+    // Чтение-преобладающий доступ к Synchronized<T>: thread_race sync [threads] [ops] [reads per write]
+    if (mode == "sync") {
+        int threads = argc > 2 ? std::atoi(argv[2]) : 8;
+        int ops = argc > 3 ? std::atoi(argv[3]) : 200000;
+        int reads = argc > 4 ? std::atoi(argv[4]) : 1000;
+        SynchronizedReadTest test(threads, ops, reads);
+        test.runAllTests();
+        return 0;
+    }
+    
+    // Задержка пробуждения поток -> поток: thread_race wakeup [round trips]
+    if (mode == "wakeup") {
+        WakeupLatencyTest test(argc > 2 ? std::atoi(argv[2]) : 20000);
+        test.runAllTests();
+        return 0;
+    }
+    
+    // BSP-движок на барьере, метод Якоби: thread_race bsp [workers] [grid n] [phases]
+    if (mode == "bsp") {
+        int workers = argc > 2 ? std::atoi(argv[2]) : 4;
+        int n = argc > 3 ? std::atoi(argv[3]) : 512;
+        int phases = argc > 4 ? std::atoi(argv[4]) : 200;
+        JacobiTest test(workers, n, phases);
+        test.runAllTests();
+        return 0;
+    }
+    
+    // Счётчики под конкуренцией: thread_race counter [max threads] [increments per thread]
+    if (mode == "counter") {
+        int threads = argc > 2 ? std::atoi(argv[2]) : 64;
+        int increments = argc > 3 ? std::atoi(argv[3]) : 100000;
+        CounterTest test(threads, increments);
+        test.runAllTests();
+        return 0;
+    }
+    
+    // Lock-free стек против стека под блокировкой: thread_race stack [threads] [pairs per thread]
+    if (mode == "stack") {
+        int threads = argc > 2 ? std::atoi(argv[2]) : 8;
+        int ops = argc > 3 ? std::atoi(argv[3]) : 200000;
+        StackRaceTest test(threads, ops);
+        test.runAllTests();
+        return 0;
+    }
+    
+    // Выделение узлов под блокировкой: thread_race alloc [threads] [ops per thread]
+    if (mode == "alloc") {
+        int threads = argc > 2 ? std::atoi(argv[2]) : 8;
+        int ops = argc > 3 ? std::atoi(argv[3]) : 200000;
+        AllocationRaceTest test(threads, ops);
+        test.runAllTests();
+        return 0;
+    }
+    
+    // Блокировки в разделяемой памяти между процессами: thread_race process [workers] [iterations]
+    if (mode == "process") {
+        int workers = argc > 2 ? std::atoi(argv[2]) : 4;
+        int iterations = argc > 3 ? std::atoi(argv[3]) : 100000;
+        ProcessSharedTest test(workers, iterations);
+        test.runAllTests();
+        return 0;
+    }
+    
+    // Профиль нагрузки: thread_race workload <file | "key=value;..."> [threads] [length]
+    if (mode == "workload") {
+        if (argc < 3) {
+            std::cerr << "usage: thread_race workload <file | \"hold=exp:2us;think=20us;shared=0.5\"> [threads] [length]\n";
+            return 1;
+        }
+        WorkloadSpec spec;
+        try {
+            spec = WorkloadSpec::load(argv[2]);
+        } catch (const std::exception& e) {
+            std::cerr << "workload: " << e.what() << "\n";
+            return 1;
+        }
+        int threads = argc > 3 ? std::atoi(argv[3]) : (spec.threads > 0 ? spec.threads : 8);
+        int length = argc > 4 ? std::atoi(argv[4]) : (spec.length > 0 ? spec.length : 1000);
+        ThreadRaceTest test(threads, length);
+        test.testWorkload(spec);
+        return 0;
+    }
+    
+    // Google Benchmark: thread_race bench [--benchmark_filter=...]; RACE_WORKLOAD добавляет BM_Workload
+    if (mode == "bench") {
+        int benchArgc = argc - 1;
+        benchmark::Initialize(&benchArgc, argv + 1);
+        benchmark::RunSpecifiedBenchmarks();
+        benchmark::Shutdown();
+        return 0;
+    }
+    
     // Простое тестирование
     ThreadRaceTest simpleTest(8, 500);
     simpleTest.runAllTests();
@@ -9,12 +232,36 @@ int main() {
     // Тестирование с разным количеством потоков
     std::cout << "\n\n=== Testing with different thread counts ===\n";
     
-    for (int threads : {2, 4, 8, 16, 32}) {
+    // Точки развёртки для подгонки USL/Амдала (1 поток - опорная точка)
+    std::vector<std::pair<std::string, void (ThreadRaceTest::*)()>> sweep{
+        {"Mutex", &ThreadRaceTest::testWithMutex},
+        {"Semaphore", &ThreadRaceTest::testWithSemaphore},
+        {"FastSemaphore", &ThreadRaceTest::testWithFastSemaphore},
+        {"SpinLock", &ThreadRaceTest::testWithSpinLock},
+        {"SpinWait", &ThreadRaceTest::testWithSpinWait},
+    };
+    std::vector<std::vector<ScalingPoint>> points(sweep.size());
+    // Одиночный короткий прогон слишком шумный для подгонки:
+    // точка - медиана нескольких прогонов
+    const int repeats = 3;
+    
+    for (int threads : {1, 2, 4, 8, 16, 32}) {
         std::cout << "\n--- " << threads << " threads ---\n";
-        ThreadRaceTest test(threads, 200);
-        test.testWithMutex();
-        test.testWithSpinLock();
-        test.testWithSpinWait();
+        ThreadRaceTest test(threads, 400);
+        for (size_t k = 0; k < sweep.size(); ++k) {
+            std::vector<double> runs;
+            for (int r = 0; r < repeats; ++r) {
+                (test.*sweep[k].second)();
+                runs.push_back(test.lastEfficiency().throughput());
+            }
+            std::nth_element(runs.begin(), runs.begin() + repeats / 2, runs.end());
+            points[k].push_back({threads, runs[repeats / 2]});
+        }
+    }
+    
+    std::cout << "\n\n=== Scalability fit (USL / Amdahl) ===\n";
+    for (size_t k = 0; k < sweep.size(); ++k) {
+        printScalingReport(sweep[k].first, points[k]);
     }
     
     return 0;
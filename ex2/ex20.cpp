@@ -7,6 +7,15 @@
 #include <thread>
 #include <mutex>
 #include <algorithm>
+#include <string_view>
+#include <cstring>
+#include <cstdint>
+#include <ctime>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 // Структура для хранения данных о призывнике
 struct Recruit {
@@ -74,6 +83,175 @@ std::vector<Recruit> readRecruitsFromFile(const std::string& filename) {
     return recruits;
 }
 
+// Файл, отображённый в память только для чтения. У пустого файла отображения
+// нет (data() == nullptr, size() == 0), но isOpen() == true.
+class MappedFile {
+private:
+    const char* begin = nullptr;
+    size_t length = 0;
+    bool opened = false;
+
+public:
+    explicit MappedFile(const std::string& filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            return;
+        }
+        opened = st.st_size == 0;
+        if (st.st_size > 0) {
+            void* p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                opened = true;
+                begin = static_cast<const char*>(p);
+                length = static_cast<size_t>(st.st_size);
+                // Читаем один раз подряд: ядро читает вперёд крупнее и раньше освобождает
+                // прочитанные страницы. Большие страницы для файлового отображения -
+                // только подсказка (работает при CONFIG_READ_ONLY_THP_FOR_FS), ошибку игнорируем.
+                ::madvise(p, length, MADV_SEQUENTIAL);
+                ::madvise(p, length, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+                ::madvise(p, length, MADV_HUGEPAGE);
+#endif
+            }
+        }
+        ::close(fd); // отображение живёт и после закрытия дескриптора
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept : begin(other.begin), length(other.length), opened(other.opened) {
+        other.begin = nullptr;
+        other.length = 0;
+        other.opened = false;
+    }
+
+    ~MappedFile() {
+        if (begin) {
+            ::munmap(const_cast<char*>(begin), length);
+        }
+    }
+
+    const char* data() const { return begin; }
+    size_t size() const { return length; }
+    bool isOpen() const { return opened; }
+};
+
+// Призывник без копий: поля - string_view в отображённый файл, записи врачей -
+// отрезок [firstRecord, firstRecord + recordCount) общего массива RecruitTable
+struct RecruitView {
+    std::string_view name;
+    std::string_view birthDate;
+    uint32_t firstRecord = 0;
+    uint32_t recordCount = 0;
+};
+
+struct DoctorRecordView {
+    std::string_view specialty;
+    std::string_view category;
+};
+
+// Результат загрузки через mmap. Владеет отображением, поэтому все string_view
+// действительны, пока жива таблица. Память - два плоских массива, без выделений
+// на поле или на призывника.
+class RecruitTable {
+private:
+    MappedFile file;
+    std::vector<RecruitView> recruits;
+    std::vector<DoctorRecordView> records;
+
+    friend RecruitTable readRecruitsMapped(const std::string& filename);
+
+    explicit RecruitTable(MappedFile&& mapped) : file(std::move(mapped)) {}
+
+public:
+    size_t size() const { return recruits.size(); }
+    const RecruitView& operator[](size_t i) const { return recruits[i]; }
+
+    bool isFitForService(const RecruitView& recruit) const {
+        for (uint32_t k = 0; k < recruit.recordCount; ++k) {
+            if (records[recruit.firstRecord + k].category == "A") {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Обычный Recruit с копиями строк - для кода, которому нужен владеющий тип
+    Recruit toRecruit(const RecruitView& recruit) const {
+        Recruit result{std::string(recruit.name), std::string(recruit.birthDate), {}};
+        for (uint32_t k = 0; k < recruit.recordCount; ++k) {
+            const DoctorRecordView& r = records[recruit.firstRecord + k];
+            result.doctorRecords.emplace_back(std::string(r.specialty), std::string(r.category));
+        }
+        return result;
+    }
+};
+
+// Загрузка через mmap: один проход по байтам файла, поля режутся по пробельным
+// символам так же, как operator>> у readRecruitsFromFile. Строка без имени и даты
+// пропускается, непарный последний токен записи врача отбрасывается.
+RecruitTable readRecruitsMapped(const std::string& filename) {
+    RecruitTable table{MappedFile(filename)};
+    if (!table.file.isOpen()) {
+        std::cerr << "Ошибка открытия файла: " << filename << std::endl;
+        return table;
+    }
+
+    const char* p = table.file.data();
+    const char* const fileEnd = p + table.file.size();
+    // Оценка по размеру: около 60 байт на строку в generateTestData
+    table.recruits.reserve(table.file.size() / 48 + 1);
+    table.records.reserve(table.file.size() / 24 + 1);
+
+    auto isSpace = [](char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    };
+
+    while (p < fileEnd) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', fileEnd - p));
+        if (lineEnd == nullptr) {
+            lineEnd = fileEnd;
+        }
+
+        // Следующий токен строки или пустой view в конце строки
+        auto nextToken = [&p, lineEnd, &isSpace]() {
+            while (p < lineEnd && isSpace(*p)) {
+                ++p;
+            }
+            const char* start = p;
+            while (p < lineEnd && !isSpace(*p)) {
+                ++p;
+            }
+            return std::string_view(start, p - start);
+        };
+
+        RecruitView recruit;
+        recruit.name = nextToken();
+        recruit.birthDate = nextToken();
+        if (!recruit.birthDate.empty()) {
+            recruit.firstRecord = static_cast<uint32_t>(table.records.size());
+            for (;;) {
+                std::string_view specialty = nextToken();
+                std::string_view category = nextToken();
+                if (category.empty()) {
+                    break;
+                }
+                table.records.push_back({specialty, category});
+            }
+            recruit.recordCount = static_cast<uint32_t>(table.records.size()) - recruit.firstRecord;
+            table.recruits.push_back(recruit);
+        }
+        p = lineEnd + 1;
+    }
+    return table;
+}
+
 // Функция для фильтрации призывников (однопоточная версия)
 std::vector<Recruit> filterRecruitsSingleThread(const std::vector<Recruit>& recruits) {
     std::vector<Recruit> suitable;
@@ -181,8 +359,24 @@ int main() {
     
     // Читаем данные из файла
     std::cout << "\nЧтение данных из файла..." << std::endl;
+    auto startRead = std::chrono::high_resolution_clock::now();
     auto recruits = readRecruitsFromFile(filename);
-    std::cout << "Прочитано " << recruits.size() << " записей о призывниках" << std::endl;
+    auto endRead = std::chrono::high_resolution_clock::now();
+    std::cout << "Прочитано " << recruits.size() << " записей о призывниках (getline + istringstream: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(endRead - startRead).count()
+              << " мс)" << std::endl;
+    
+    // То же через mmap без копирования полей
+    auto startMapped = std::chrono::high_resolution_clock::now();
+    RecruitTable mapped = readRecruitsMapped(filename);
+    auto endMapped = std::chrono::high_resolution_clock::now();
+    size_t mappedFit = 0;
+    for (size_t i = 0; i < mapped.size(); ++i) {
+        mappedFit += mapped.isFitForService(mapped[i]) ? 1 : 0;
+    }
+    std::cout << "Прочитано " << mapped.size() << " записей через mmap + string_view: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(endMapped - startMapped).count()
+              << " мс" << std::endl;
     
     // Однопоточная обработка
     std::cout << "\n=== Однопоточная обработка ===" << std::endl;
@@ -205,7 +399,8 @@ int main() {
     std::cout << "Найдено пригодных призывников: " << suitableMulti.size() << std::endl;
     
     // Проверяем, что результаты совпадают
-    if (suitableSingle.size() == suitableMulti.size()) {
+    if (suitableSingle.size() == suitableMulti.size() && suitableSingle.size() == mappedFit
+        && recruits.size() == mapped.size()) {
         std::cout << "\nРезультаты обработки совпадают!" << std::endl;
     } else {
         std::cout << "\nВнимание: результаты не совпадают!" << std::endl;
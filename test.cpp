@@ -7,6 +7,15 @@
 #include <chrono>
 #include <random>
 #include <cstring>
+#include <cstdlib>
+#include <deque>
+#include <algorithm>
+#include "ex1/FastSemaphore.h"
+#include "ex1/Locks.h"
+#include "ex1/LockProfiler.h"
+#include "ex1/CpuUsage.h"
+#include "ex1/SeqLock.h"
+#include "ex1/WorkloadSpec.h"
 
 using namespace std;
 using namespace chrono;
@@ -16,21 +25,23 @@ const int NUM_ITERATIONS = 100000;
 
 // 1. Мьютекс
 mutex mtx;
+ProfiledLock<mutex> mtx_site(mtx, "test.cpp mutex_worker");
 void mutex_worker(int id, vector<char>& data) {
     for (int i = 0; i < NUM_ITERATIONS; ++i) {
-        lock_guard<mutex> lock(mtx);
+        lock_guard<ProfiledLock<mutex>> lock(mtx_site);
         data[id] = static_cast<char>(33 + rand() % 94); 
     }
 }
 
 // 2. Семафор
-class Semaphore {
+// Старая реализация на мьютексе и condition_variable - оставлена для сравнения
+class CondVarSemaphore {
 private:
     mutex mtx;
     condition_variable cv;
     int count;
 public:
-    Semaphore(int count = 1) : count(count) {}
+    CondVarSemaphore(int count = 1) : count(count) {}
     
     void acquire() {
         unique_lock<mutex> lock(mtx);
@@ -45,12 +56,26 @@ public:
     }
 };
 
+// Основной семафор: быстрый путь - один CAS, в ядро только при нехватке разрешений
+using Semaphore = FastSemaphore;
+
 Semaphore semaphore(1);
+ProfiledLock<Semaphore> semaphore_site(semaphore, "test.cpp semaphore_worker");
 void semaphore_worker(int id, vector<char>& data) {
     for (int i = 0; i < NUM_ITERATIONS; ++i) {
-        semaphore.acquire();
+        semaphore_site.acquire();
+        data[id] = static_cast<char>(33 + rand() % 94);
+        semaphore_site.release();
+    }
+}
+
+CondVarSemaphore condvar_semaphore(1);
+ProfiledLock<CondVarSemaphore> condvar_semaphore_site(condvar_semaphore, "test.cpp condvar_semaphore_worker");
+void condvar_semaphore_worker(int id, vector<char>& data) {
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+        condvar_semaphore_site.acquire();
         data[id] = static_cast<char>(33 + rand() % 94);
-        semaphore.release();
+        condvar_semaphore_site.release();
     }
 }
 
@@ -79,25 +104,25 @@ public:
     }
 };
 
-// 4. SpinLock
-atomic_flag spinlock = ATOMIC_FLAG_INIT;
+// 4. SpinLock (test_and_set в цикле, ex1/Locks.h)
+TasSpinLock spinlock;
+ProfiledLock<TasSpinLock> spinlock_site(spinlock, "test.cpp spinlock_worker");
 void spinlock_worker(int id, vector<char>& data) {
     for (int i = 0; i < NUM_ITERATIONS; ++i) {
-        while (spinlock.test_and_set(memory_order_acquire)) {}
+        spinlock_site.lock();
         data[id] = static_cast<char>(33 + rand() % 94);
-        spinlock.clear(memory_order_release);
+        spinlock_site.unlock();
     }
 }
 
-// 5. SpinWait
-atomic_flag spinlock2 = ATOMIC_FLAG_INIT;
+// 5. SpinWait (пауза -> yield -> сон -> парковка на futex, ex1/SpinWait.h)
+SpinWaitLock spinlock2;
+ProfiledLock<SpinWaitLock> spinlock2_site(spinlock2, "test.cpp spinwait_worker");
 void spinwait_worker(int id, vector<char>& data) {
     for (int i = 0; i < NUM_ITERATIONS; ++i) {
-        while (spinlock2.test_and_set(memory_order_acquire)) {
-            this_thread::yield();
-        }
+        spinlock2_site.lock();
         data[id] = static_cast<char>(33 + rand() % 94);
-        spinlock2.clear(memory_order_release);
+        spinlock2_site.unlock();
     }
 }
 
@@ -108,11 +133,16 @@ private:
     condition_variable cv;
     bool available;
 public:
+    atomic<long long> wakeups{0}; // сколько раз поток просыпался в enter()
+    
     Monitor() : available(true) {}
     
     void enter() {
         unique_lock<mutex> lock(mtx);
-        cv.wait(lock, [this](){ return available; });
+        while (!available) {
+            cv.wait(lock);
+            wakeups.fetch_add(1, memory_order_relaxed);
+        }
         available = false;
     }
     
@@ -125,24 +155,169 @@ public:
     }
 };
 
+// 6б. Monitor с FIFO-очередью ожидающих и прямой передачей владения.
+// exit() отдаёт монитор первому в очереди, не освобождая его, поэтому
+// разбуженный поток не может проиграть гонку "влезающему" потоку.
+// barge_limit > 0 включает гибрид: до barge_limit захватов подряд можно
+// сделать в обход очереди, затем владение передаётся напрямую.
+class HandoffMonitor {
+private:
+    struct Waiter {
+        condition_variable cv;
+        bool granted = false;
+    };
+    
+    mutex mtx;
+    deque<Waiter*> queue;
+    bool owned = false;
+    int barges = 0;
+    const int barge_limit;
+public:
+    atomic<long long> wakeups{0};
+    
+    explicit HandoffMonitor(int barge_limit = 0) : barge_limit(barge_limit) {}
+    
+    void enter() {
+        unique_lock<mutex> lock(mtx);
+        if (!owned && (queue.empty() || barges < barge_limit)) {
+            owned = true;
+            if (!queue.empty()) {
+                ++barges;
+            }
+            return;
+        }
+        
+        Waiter self;
+        queue.push_back(&self);
+        for (;;) {
+            self.cv.wait(lock);
+            wakeups.fetch_add(1, memory_order_relaxed);
+            if (self.granted) {
+                return; // владение уже передано в exit()
+            }
+            if (!owned && queue.front() == &self) {
+                queue.pop_front();
+                owned = true;
+                barges = 0;
+                return;
+            }
+        }
+    }
+    
+    void exit() {
+        lock_guard<mutex> lock(mtx);
+        if (queue.empty()) {
+            owned = false;
+            return;
+        }
+        Waiter* next = queue.front();
+        if (barges < barge_limit) {
+            // Гибрид: освобождаем и будим голову очереди, но не гарантируем ей захват
+            owned = false;
+        } else {
+            queue.pop_front();
+            next->granted = true;
+            barges = 0;
+        }
+        // notify под мьютексом: после unlock ожидающий может уйти и разрушить Waiter
+        next->cv.notify_one();
+    }
+};
+
 Monitor monitor;
+ProfiledLock<Monitor> monitor_site(monitor, "test.cpp monitor_worker");
 void monitor_worker(int id, vector<char>& data) {
     for (int i = 0; i < NUM_ITERATIONS; ++i) {
-        monitor.enter();
+        monitor_site.enter();
         data[id] = static_cast<char>(33 + rand() % 94);
-        monitor.exit();
+        monitor_site.exit();
     }
 }
 
-// Функция для запуска теста
-void run_test(const string& name, void (*worker)(int, vector<char>&)) {
+HandoffMonitor handoff_monitor;
+ProfiledLock<HandoffMonitor> handoff_monitor_site(handoff_monitor, "test.cpp handoff_monitor_worker");
+void handoff_monitor_worker(int id, vector<char>& data) {
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+        handoff_monitor_site.enter();
+        data[id] = static_cast<char>(33 + rand() % 94);
+        handoff_monitor_site.exit();
+    }
+}
+
+// Перцентиль по отсортированному вектору
+long long percentile(const vector<long long>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t idx = static_cast<size_t>(p * (sorted.size() - 1));
+    return sorted[idx];
+}
+
+// Замер ожидания в enter(): пробуждения на захват и p50/p99/max в наносекундах
+template <typename M>
+void monitor_latency(const string& name, M& mon, int iterations = NUM_ITERATIONS) {
     vector<thread> threads;
     vector<char> data(NUM_THREADS, ' ');
+    vector<vector<long long>> waits(NUM_THREADS);
+    long long wakeups_before = mon.wakeups.load();
+    
+    for (int id = 0; id < NUM_THREADS; ++id) {
+        threads.emplace_back([&, id]() {
+            waits[id].reserve(iterations);
+            for (int i = 0; i < iterations; ++i) {
+                auto t0 = steady_clock::now();
+                mon.enter();
+                auto t1 = steady_clock::now();
+                data[id] = static_cast<char>(33 + rand() % 94);
+                mon.exit();
+                waits[id].push_back(duration_cast<nanoseconds>(t1 - t0).count());
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    
+    vector<long long> all;
+    for (auto& w : waits) {
+        all.insert(all.end(), w.begin(), w.end());
+    }
+    sort(all.begin(), all.end());
+    double acquisitions = static_cast<double>(all.size());
+    
+    cout << name << ": пробуждений/захват " 
+         << (mon.wakeups.load() - wakeups_before) / acquisitions
+         << ", ожидание p50 " << percentile(all, 0.50) 
+         << " нс, p99 " << percentile(all, 0.99) 
+         << " нс, max " << (all.empty() ? 0 : all.back()) << " нс" << endl;
+}
+
+void monitor_comparison() {
+    cout << "\n=== Monitor: notify_one против FIFO-передачи владения ===" << endl;
+    Monitor plain;
+    HandoffMonitor fifo;
+    HandoffMonitor hybrid(4);
+    monitor_latency("Monitor (notify_one)  ", plain);
+    monitor_latency("HandoffMonitor (FIFO) ", fifo);
+    monitor_latency("HandoffMonitor (гибрид)", hybrid);
+}
+
+// Функция для запуска теста, возвращает время в микросекундах
+long long run_test(const string& name, void (*worker)(int, vector<char>&), int num_threads = NUM_THREADS) {
+    vector<thread> threads;
+    vector<char> data(num_threads, ' ');
+    vector<CpuUsage> cpu(num_threads);
     
     auto start = high_resolution_clock::now();
     
-    for (int i = 0; i < NUM_THREADS; ++i) {
-        threads.emplace_back(worker, i, ref(data));
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&cpu, &data, &name, worker, i]() {
+            CpuUsage before = CpuUsage::thisThread();
+            RACE_TRACE_PHASE_BEGIN(name);
+            worker(i, data);
+            RACE_TRACE_PHASE_END(name);
+            cpu[i] = CpuUsage::thisThread() - before;
+        });
     }
     
     for (auto& t : threads) {
@@ -153,24 +328,118 @@ void run_test(const string& name, void (*worker)(int, vector<char>&)) {
     auto duration = duration_cast<milliseconds>(end - start);
     
     cout << name << ": " << duration.count() << " ms" << endl;
+    RunEfficiency::fromThreads(duration_cast<microseconds>(end - start).count() / 1e6,
+                               1LL * num_threads * NUM_ITERATIONS, cpu).print();
+    return duration_cast<microseconds>(end - start).count();
 }
 
-// ДЕМОНСТРАЦИОННАЯ ФУНКЦИЯ: Запуск "гонки" с выводом символов
-void race_demonstration() {
-    cout << "\n=== ДЕМОНСТРАЦИЯ ГОНКИ ПОТОКОВ (Monitor) ===" << endl;
-    cout << "Каждый поток выводит по 10 символов:" << endl;
+// Сравнение семафоров: без конкуренции (1 поток) и под конкуренцией
+void semaphore_speedup() {
+    cout << "\n=== Семафор: FastSemaphore против мьютекса + condvar ===" << endl;
     
-    Monitor race_monitor;
+    long long cv_single = run_test("CondVar  1 поток ", condvar_semaphore_worker, 1);
+    long long fast_single = run_test("Fast     1 поток ", semaphore_worker, 1);
+    long long cv_multi = run_test("CondVar  " + to_string(NUM_THREADS) + " потоков", condvar_semaphore_worker);
+    long long fast_multi = run_test("Fast     " + to_string(NUM_THREADS) + " потоков", semaphore_worker);
+    
+    cout << "Ускорение без конкуренции: " 
+         << static_cast<double>(cv_single) / max(fast_single, 1LL) << "x" << endl;
+    cout << "Ускорение под конкуренцией: " 
+         << static_cast<double>(cv_multi) / max(fast_multi, 1LL) << "x" << endl;
+}
+
+// Профиль нагрузки (ex1/WorkloadSpec.h): пауза вне блокировки, удержание по
+// распределению, часть захватов - на собственную блокировку потока.
+// Число потоков и итераций здесь всегда NUM_THREADS и NUM_ITERATIONS.
+const WorkloadSpec* workload_spec = nullptr;
+
+template <typename Lock>
+void workload_worker(int id, vector<char>& data) {
+    static Lock shared_lock;
+    static ProfiledLock<Lock> shared_site(shared_lock, "test.cpp workload_worker shared");
+    struct alignas(64) PaddedLock {
+        Lock lock;
+    };
+    static PaddedLock own[NUM_THREADS];
+    
+    ProfiledLock<Lock> own_site(own[id].lock, "test.cpp workload_worker private");
+    
+    mt19937_64 rng(random_device{}());
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+        spendWorkloadTime(workload_spec->sampleThink(id, rng));
+        if (workload_spec->pickShared(rng)) {
+            lock_guard<ProfiledLock<Lock>> lock(shared_site);
+            data[id] = static_cast<char>(33 + rand() % 94);
+            spendWorkloadTime(workload_spec->sampleHold(id, rng));
+        } else {
+            lock_guard<ProfiledLock<Lock>> lock(own_site);
+            data[id] = static_cast<char>(33 + rand() % 94);
+            spendWorkloadTime(workload_spec->sampleHold(id, rng));
+        }
+    }
+}
+
+void workload_comparison(const WorkloadSpec& spec) {
+    cout << "\n=== Профиль нагрузки " << spec.describe() << " ===" << endl;
+    workload_spec = &spec;
+    run_test("Mutex        ", workload_worker<mutex>);
+    run_test("Semaphore    ", workload_worker<FastSemaphore>);
+    run_test("SpinLock     ", workload_worker<TasSpinLock>);
+    run_test("SpinWait     ", workload_worker<SpinWaitLock>);
+    workload_spec = nullptr;
+}
+
+// Состояние потока в демонстрации: пишется внутри монитора, читается наблюдателем
+struct RaceCell {
+    int step;   // глобальный номер шага, -1 - ещё не ходил
+    int done;   // сколько символов поток уже вывел
+    char symbol;
+};
+
+// ДЕМОНСТРАЦИОННАЯ ФУНКЦИЯ: Запуск "гонки" с выводом символов.
+// Потоки не печатают под монитором: каждый пишет свой символ в свой seqlock,
+// а отдельный поток-наблюдатель 60 раз в секунду печатает снимок гонки.
+template <typename M = Monitor>
+void race_demonstration(const string& title = "Monitor") {
+    cout << "\n=== ДЕМОНСТРАЦИЯ ГОНКИ ПОТОКОВ (" << title << ") ===" << endl;
+    cout << "Каждый поток выводит по 10 символов (поток: 'символ' шаг/сделано):" << endl;
+    
+    M raw_monitor;
+    ProfiledLock<M> race_monitor(raw_monitor, "test.cpp race_demonstration<" + title + ">");
     vector<thread> race_threads;
     atomic<int> counter{0};
     const int chars_per_thread = 10;
+    vector<long long> waits(NUM_THREADS * chars_per_thread);
     
-    auto race_worker = [&race_monitor, &counter](int id) {
+    struct alignas(64) PaddedCell {
+        SeqLock<RaceCell> cell{RaceCell{-1, 0, ' '}};
+    };
+    vector<PaddedCell> cells(NUM_THREADS);
+    atomic<bool> finished{false};
+    
+    auto print_snapshot = [&cells](const string& label) {
+        cout << label;
+        for (int id = 0; id < NUM_THREADS; ++id) {
+            RaceCell c = cells[id].cell.read();
+            cout << "  " << id << ": '" << c.symbol << "' " << c.step << "/" << c.done;
+        }
+        cout << endl;
+    };
+    
+    thread observer([&finished, &print_snapshot]() {
+        auto start = steady_clock::now();
+        while (!finished.load(memory_order_acquire)) {
+            this_thread::sleep_for(milliseconds(1000 / 60));
+            print_snapshot("[+" + to_string(duration_cast<milliseconds>(steady_clock::now() - start).count()) + " мс]");
+        }
+    });
+    
+    auto race_worker = [&race_monitor, &counter, &waits, &cells](int id) {
         for (int i = 0; i < chars_per_thread; ++i) {
+            auto t0 = steady_clock::now();
             race_monitor.enter();
-            cout << "Поток " << id << ": '" 
-                 << static_cast<char>(33 + rand() % 94) 
-                 << "' (шаг " << counter++ << ")" << endl;
+            waits[id * chars_per_thread + i] = duration_cast<nanoseconds>(steady_clock::now() - t0).count();
+            cells[id].cell.write(RaceCell{counter++, i + 1, static_cast<char>(33 + rand() % 94)});
             race_monitor.exit();
             this_thread::sleep_for(milliseconds(10)); // Замедляем для наглядности
         }
@@ -183,11 +452,41 @@ void race_demonstration() {
     for (auto& t : race_threads) {
         t.join();
     }
+    finished.store(true, memory_order_release);
+    observer.join();
+    print_snapshot("[итог]");
+    
+    sort(waits.begin(), waits.end());
+    cout << title << ": пробуждений/захват " 
+         << static_cast<double>(raw_monitor.wakeups.load()) / waits.size()
+         << ", ожидание p99 " << percentile(waits, 0.99) << " нс" << endl;
 }
 
 int main() {
     srand(time(nullptr));
     
+    // Профилировщик блокировок: LOCK_PROFILE=<период выборки>, например LOCK_PROFILE=16
+    // (0 или не число - профилировщик выключен)
+    if (const char* profile = getenv("LOCK_PROFILE"); profile && atoi(profile) > 0) {
+        LockProfiler::instance().enable(true, atoi(profile));
+    }
+    
+    // Профиль нагрузки: RACE_WORKLOAD=<файл> или RACE_WORKLOAD="hold=exp:2us;think=20us;shared=0.5"
+    if (const char* workload = getenv("RACE_WORKLOAD")) {
+        WorkloadSpec spec;
+        try {
+            spec = WorkloadSpec::load(workload);
+        } catch (const exception& e) {
+            cerr << "RACE_WORKLOAD: " << e.what() << endl;
+            return 1;
+        }
+        workload_comparison(spec);
+        if (LockProfiler::isEnabled()) {
+            LockProfiler::instance().report();
+        }
+        return 0;
+    }
+    
     cout << "Сравнение примитивов синхронизации (" << NUM_THREADS << " потоков, " 
          << NUM_ITERATIONS << " итераций):" << endl;
     
@@ -196,7 +495,8 @@ int main() {
     
     // Для barrier нужно отдельное создание в каждом тесте
     {
-        Barrier barrier(NUM_THREADS);
+        Barrier raw_barrier(NUM_THREADS);
+        ProfiledBarrier<Barrier> barrier(raw_barrier, "test.cpp barrier");
         auto barrier_wrapper = [&barrier](int id, vector<char>& data) {
             for (int i = 0; i < NUM_ITERATIONS; ++i) {
                 data[id] = static_cast<char>(33 + rand() % 94);
@@ -206,10 +506,15 @@ int main() {
         
         vector<thread> threads;
         vector<char> data(NUM_THREADS, ' ');
+        vector<CpuUsage> cpu(NUM_THREADS);
         auto start = high_resolution_clock::now();
         
         for (int i = 0; i < NUM_THREADS; ++i) {
-            threads.emplace_back(barrier_wrapper, i, ref(data));
+            threads.emplace_back([&cpu, &data, &barrier_wrapper, i]() {
+                CpuUsage before = CpuUsage::thisThread();
+                barrier_wrapper(i, data);
+                cpu[i] = CpuUsage::thisThread() - before;
+            });
         }
         
         for (auto& t : threads) {
@@ -219,14 +524,25 @@ int main() {
         auto end = high_resolution_clock::now();
         auto duration = duration_cast<milliseconds>(end - start);
         cout << "Barrier      : " << duration.count() << " ms" << endl;
+        RunEfficiency::fromThreads(duration_cast<microseconds>(end - start).count() / 1e6,
+                                   1LL * NUM_THREADS * NUM_ITERATIONS, cpu).print();
     }
     
     run_test("SpinLock     ", spinlock_worker);
     run_test("SpinWait     ", spinwait_worker);
     run_test("Monitor      ", monitor_worker);
+    run_test("HandoffMon.  ", handoff_monitor_worker);
+    
+    semaphore_speedup();
+    monitor_comparison();
     
     // Запускаем демонстрацию гонки
     race_demonstration();
+    race_demonstration<HandoffMonitor>("HandoffMonitor");
+    
+    if (LockProfiler::isEnabled()) {
+        LockProfiler::instance().report();
+    }
     
     return 0;
 }